@@ -229,8 +229,9 @@ bool VehicleCargoReroute::operator()(CargoPacket *cp)
 		this->destination->AddToMeta(cp_new, VehicleCargoList::MTA_TRANSFER);
 	}
 
-	/* Legal, as front pushing doesn't invalidate iterators in std::list. */
-	this->destination->packets.push_front(cp_new);
+	/* The packets can't be prepended right away as the destination may be
+	 * the list we're iterating. VehicleCargoList::Reroute() does it later. */
+	this->rerouted.push_back(cp_new);
 	return cp_new == cp;
 }
 
@@ -13,6 +13,7 @@
 #define CARGOACTION_H
 
 #include "cargopacket.h"
+#include <vector>
 
 /**
  * Abstract action of removing cargo from a vehicle or a station.
@@ -134,6 +135,8 @@ public:
 
 /** Action of rerouting cargo staged for transfer in a vehicle. */
 class VehicleCargoReroute : public CargoReroute<VehicleCargoList> {
+protected:
+	std::vector<CargoPacket *> rerouted; ///< Packets to be prepended to the destination, in order of processing.
 public:
 	VehicleCargoReroute(VehicleCargoList *source, VehicleCargoList *dest, uint max_move, StationID avoid, StationID avoid2, const GoodsEntry *ge) :
 			CargoReroute<VehicleCargoList>(source, dest, max_move, avoid, avoid2, ge)
@@ -141,6 +144,12 @@ public:
 		assert(this->max_move <= source->ActionCount(VehicleCargoList::MTA_TRANSFER));
 	}
 	bool operator()(CargoPacket *cp);
+
+	/**
+	 * Get the packets rerouted so far.
+	 * @return Rerouted packets, in the order they were processed.
+	 */
+	const std::vector<CargoPacket *> &Rerouted() const { return this->rerouted; }
 };
 
 #endif /* CARGOACTION_H */
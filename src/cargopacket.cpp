@@ -256,6 +256,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	assert(cp != nullptr);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
+	this->ApplyPendingAging();
 	this->AddToMeta(cp, action);
 
 	if (this->count == cp->count) {
@@ -279,6 +280,8 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 
 /**
  * Shifts cargo from the front of the packet list and applies some action to it.
+ * The packets the action consumed are removed from the list in one go
+ * afterwards, so the action must not modify this list itself.
  * @tparam Taction Action class or function to be used. It should define
  *                 "bool operator()(CargoPacket *)". If true is returned the
  *                 cargo packet will be removed from the list. Otherwise it
@@ -286,21 +289,21 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
  * @param action Action instance to be applied.
  */
 template<class Taction>
-void VehicleCargoList::ShiftCargo(Taction action)
+void VehicleCargoList::ShiftCargo(Taction &action)
 {
+	this->ApplyPendingAging();
 	Iterator it(this->packets.begin());
 	while (it != this->packets.end() && action.MaxMove() > 0) {
-		CargoPacket *cp = *it;
-		if (action(cp)) {
-			it = this->packets.erase(it);
-		} else {
-			break;
-		}
+		if (!action(*it)) break;
+		++it;
 	}
+	this->packets.erase(this->packets.begin(), it);
 }
 
 /**
  * Pops cargo from the back of the packet list and applies some action to it.
+ * The packets the action consumed are removed from the list in one go
+ * afterwards, so the action must not modify this list itself.
  * @tparam Taction Action class or function to be used. It should define
  *                 "bool operator()(CargoPacket *)". If true is returned the
  *                 cargo packet will be removed from the list. Otherwise it
@@ -308,24 +311,15 @@ void VehicleCargoList::ShiftCargo(Taction action)
  * @param action Action instance to be applied.
  */
 template<class Taction>
-void VehicleCargoList::PopCargo(Taction action)
+void VehicleCargoList::PopCargo(Taction &action)
 {
-	if (this->packets.empty()) return;
-	Iterator it(--(this->packets.end()));
-	Iterator begin(this->packets.begin());
-	while (action.MaxMove() > 0) {
-		CargoPacket *cp = *it;
-		if (action(cp)) {
-			if (it != begin) {
-				this->packets.erase(it--);
-			} else {
-				this->packets.erase(it);
-				break;
-			}
-		} else {
-			break;
-		}
+	this->ApplyPendingAging();
+	ReverseIterator it(this->packets.rbegin());
+	while (it != this->packets.rend() && action.MaxMove() > 0) {
+		if (!action(*it)) break;
+		++it;
 	}
+	this->packets.erase(it.base(), this->packets.end());
 }
 
 /**
@@ -348,6 +342,7 @@ void VehicleCargoList::RemoveFromCache(const CargoPacket *cp, uint count)
 void VehicleCargoList::AddToCache(const CargoPacket *cp)
 {
 	this->feeder_share += cp->feeder_share;
+	this->max_days_in_transit = max(this->max_days_in_transit, cp->days_in_transit);
 	this->Parent::AddToCache(cp);
 }
 
@@ -380,18 +375,53 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Ages the all cargo in this list. As long as no packet can reach the
+ * maximum age only the caches are updated; the packets themselves are aged
+ * by ApplyPendingAging() the next time they are needed.
  */
 void VehicleCargoList::AgeCargo()
 {
+	if (this->packets.empty()) {
+		this->max_days_in_transit = 0;
+		this->pending_aging = 0;
+		return;
+	}
+
+	if (this->max_days_in_transit + this->pending_aging < 0xFF) {
+		this->pending_aging++;
+		this->cargo_days_in_transit += this->count;
+		return;
+	}
+
+	this->ApplyPendingAging();
+	byte max_days = 0;
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		CargoPacket *cp = *it;
 		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
+		if (cp->days_in_transit != 0xFF) {
+			cp->days_in_transit++;
+			this->cargo_days_in_transit += cp->count;
+		}
+		max_days = max(max_days, cp->days_in_transit);
+	}
+	this->max_days_in_transit = max_days;
+}
+
+/**
+ * Apply the aging steps recorded by AgeCargo() to the packets. This has to
+ * be done before the packets' days in transit are used or packets are added
+ * to or removed from the list.
+ */
+void VehicleCargoList::ApplyPendingAging()
+{
+	if (this->pending_aging == 0) return;
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+	/* AgeCargo() made sure none of the packets passes the maximum. */
+	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
+		(*it)->days_in_transit += this->pending_aging;
 	}
+	this->max_days_in_transit += this->pending_aging;
+	this->pending_aging = 0;
 }
 
 /**
@@ -451,19 +481,22 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 {
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
+	this->ApplyPendingAging();
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
-	Iterator deliver = this->packets.end();
-	Iterator it = this->packets.begin();
+
+	/* The packets are sorted into one bucket per action and the list is
+	 * rebuilt from those afterwards. Transferred packets end up in reverse
+	 * order at the front, as they used to when being prepended one by one. */
+	std::vector<CargoPacket *> staged[MTA_LOAD];
 	uint sum = 0;
 
 	bool force_keep = (order_flags & OUFB_NO_UNLOAD) != 0;
 	bool force_unload = (order_flags & OUFB_UNLOAD) != 0;
 	bool force_transfer = (order_flags & (OUFB_TRANSFER | OUFB_UNLOAD)) != 0;
-	assert(this->count > 0 || it == this->packets.end());
-	while (sum < this->count) {
+	assert(this->count > 0 || this->packets.empty());
+	for (Iterator it(this->packets.begin()); it != this->packets.end(); ++it) {
 		CargoPacket *cp = *it;
 
-		this->packets.erase(it++);
 		StationID cargo_next = INVALID_STATION;
 		MoveToAction action = MTA_LOAD;
 		if (force_keep) {
@@ -514,14 +547,9 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 		Money share;
 		switch (action) {
 			case MTA_KEEP:
-				this->packets.push_back(cp);
-				if (deliver == this->packets.end()) --deliver;
-				break;
 			case MTA_DELIVER:
-				this->packets.insert(deliver, cp);
 				break;
 			case MTA_TRANSFER:
-				this->packets.push_front(cp);
 				/* Add feeder share here to allow reusing field for next station. */
 				share = payment->PayTransfer(cp, cp->count);
 				cp->AddFeederShare(share);
@@ -531,9 +559,15 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 			default:
 				NOT_REACHED();
 		}
+		staged[action].push_back(cp);
 		this->action_counts[action] += cp->count;
 		sum += cp->count;
 	}
+	assert(sum == this->count);
+
+	this->packets.assign(staged[MTA_TRANSFER].rbegin(), staged[MTA_TRANSFER].rend());
+	this->packets.insert(this->packets.end(), staged[MTA_DELIVER].begin(), staged[MTA_DELIVER].end());
+	this->packets.insert(this->packets.end(), staged[MTA_KEEP].begin(), staged[MTA_KEEP].end());
 	this->AssertCountConsistency();
 	return this->action_counts[MTA_DELIVER] > 0 || this->action_counts[MTA_TRANSFER] > 0;
 }
@@ -543,6 +577,8 @@ void VehicleCargoList::InvalidateCache()
 {
 	this->feeder_share = 0;
 	this->Parent::InvalidateCache();
+	/* The pending aging never takes a packet past the maximum. */
+	this->cargo_days_in_transit += this->pending_aging * this->count;
 }
 
 /**
@@ -579,16 +615,17 @@ template<>
 uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList::MTA_TRANSFER>(uint max_move, TileOrStationID next_station)
 {
 	max_move = min(this->action_counts[MTA_DELIVER], max_move);
+	this->ApplyPendingAging();
 
 	uint sum = 0;
-	for (Iterator it(this->packets.begin()); sum < this->action_counts[MTA_TRANSFER] + max_move;) {
-		CargoPacket *cp = *it++;
+	for (size_t i = 0; sum < this->action_counts[MTA_TRANSFER] + max_move; i++) {
+		CargoPacket *cp = this->packets[i];
 		sum += cp->Count();
 		if (sum <= this->action_counts[MTA_TRANSFER]) continue;
 		if (sum > this->action_counts[MTA_TRANSFER] + max_move) {
 			CargoPacket *cp_split = cp->Split(sum - this->action_counts[MTA_TRANSFER] + max_move);
 			sum -= cp_split->Count();
-			this->packets.insert(it, cp_split);
+			this->packets.insert(this->packets.begin() + i + 1, cp_split);
 		}
 		cp->next_station = next_station;
 	}
@@ -608,7 +645,8 @@ uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList:
 uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID next)
 {
 	max_move = min(this->action_counts[MTA_LOAD], max_move);
-	this->PopCargo(CargoReturn(this, dest, max_move, next));
+	CargoReturn action(this, dest, max_move, next);
+	this->PopCargo(action);
 	return max_move;
 }
 
@@ -621,7 +659,8 @@ uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID n
 uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
 {
 	max_move = min(this->count, max_move);
-	this->PopCargo(CargoShift(this, dest, max_move));
+	CargoShift action(this, dest, max_move);
+	this->PopCargo(action);
 	return max_move;
 }
 
@@ -638,12 +677,14 @@ uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPaymen
 	uint moved = 0;
 	if (this->action_counts[MTA_TRANSFER] > 0) {
 		uint move = min(this->action_counts[MTA_TRANSFER], max_move);
-		this->ShiftCargo(CargoTransfer(this, dest, move));
+		CargoTransfer action(this, dest, move);
+		this->ShiftCargo(action);
 		moved += move;
 	}
 	if (this->action_counts[MTA_TRANSFER] == 0 && this->action_counts[MTA_DELIVER] > 0 && moved < max_move) {
 		uint move = min(this->action_counts[MTA_DELIVER], max_move - moved);
-		this->ShiftCargo(CargoDelivery(this, move, payment));
+		CargoDelivery action(this, move, payment);
+		this->ShiftCargo(action);
 		moved += move;
 	}
 	return moved;
@@ -657,8 +698,21 @@ uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPaymen
  */
 uint VehicleCargoList::Truncate(uint max_move)
 {
-	max_move = min(this->count, max_move);
-	this->PopCargo(CargoRemoval<VehicleCargoList>(this, max_move));
+	if (max_move >= this->count) {
+		/* Everything goes; no need to update the caches packet by packet. */
+		max_move = this->count;
+		for (Iterator it(this->packets.begin()); it != this->packets.end(); ++it) delete *it;
+		this->packets.clear();
+		this->count = 0;
+		this->cargo_days_in_transit = 0;
+		this->feeder_share = 0;
+		MemSetT(this->action_counts, 0, NUM_MOVE_TO_ACTION);
+		this->max_days_in_transit = 0;
+		this->pending_aging = 0;
+		return max_move;
+	}
+	CargoRemoval<VehicleCargoList> action(this, max_move);
+	this->PopCargo(action);
 	return max_move;
 }
 
@@ -673,7 +727,14 @@ uint VehicleCargoList::Truncate(uint max_move)
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
 	max_move = min(this->action_counts[MTA_TRANSFER], max_move);
-	this->ShiftCargo(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge));
+	dest->ApplyPendingAging();
+	VehicleCargoReroute action(this, dest, max_move, avoid, avoid2, ge);
+	this->ShiftCargo(action);
+
+	/* Prepend the rerouted packets only now, as dest may be this very list.
+	 * They end up in reverse order, like with pushing them to the front one by one. */
+	const std::vector<CargoPacket *> &rerouted = action.Rerouted();
+	dest->packets.insert(dest->packets.begin(), rerouted.rbegin(), rerouted.rend());
 	return max_move;
 }
 
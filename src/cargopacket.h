@@ -19,7 +19,7 @@
 #include "cargo_type.h"
 #include "vehicle_type.h"
 #include "core/multimap.hpp"
-#include <list>
+#include <deque>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -275,7 +275,15 @@ public:
 	void InvalidateCache();
 };
 
-typedef std::list<CargoPacket *> CargoPacketList;
+/**
+ * Storage for the packets of a vehicle. The packets are kept in one
+ * contiguous sequence that is partitioned by MoveToAction: first the packets
+ * to be transferred, then those to be delivered, then those to be kept and
+ * finally the ones reserved for loading. The partitions are only tracked via
+ * the action_counts of the VehicleCargoList, so moving cargo between adjacent
+ * partitions doesn't touch the packets at all.
+ */
+typedef std::deque<CargoPacket *> CargoPacketList;
 
 /**
  * CargoList that is used for vehicles.
@@ -287,12 +295,14 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transfered, delivered, kept and loaded.
+	byte max_days_in_transit;               ///< Upper bound for the days in transit of the packets, not counting pending_aging.
+	byte pending_aging;                     ///< Number of aging steps already in the caches, but not yet applied to the packets.
 
 	template<class Taction>
-	void ShiftCargo(Taction action);
+	void ShiftCargo(Taction &action);
 
 	template<class Taction>
-	void PopCargo(Taction action);
+	void PopCargo(Taction &action);
 
 	/**
 	 * Assert that the designation counts add up.
@@ -408,6 +418,8 @@ public:
 
 	void AgeCargo();
 
+	void ApplyPendingAging();
+
 	void InvalidateCache();
 
 	void SetTransferLoadPlace(TileIndex xy);
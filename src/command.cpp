@@ -26,6 +26,7 @@
 #include "signal_func.h"
 #include "core/backup_type.hpp"
 #include "object_base.h"
+#include "command_replay.h"
 
 #include "table/strings.h"
 
@@ -558,6 +559,9 @@ bool DoCommandP(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, CommandCallbac
 	 * However, in case of incoming network commands,
 	 * map generation or the pause button we do want
 	 * to execute. */
+	/* The recording being replayed already contains the commands the game itself sent over the network. */
+	if (SkipCommandDuringReplay(cmd)) return false;
+
 	bool estimate_only = _shift_pressed && IsLocalCompany() &&
 			!_generating_world &&
 			!(cmd & CMD_NETWORK_COMMAND) &&
@@ -710,6 +714,7 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd,
 		return_dcpi(CommandCost());
 	}
 	DEBUG(desync, 1, "cmd: %08x; %02x; %02x; %06x; %08x; %08x; %08x; \"%s\" (%s)", _date, _date_fract, (int)_current_company, tile, p1, p2, cmd & ~CMD_NETWORK_COMMAND, text, GetCommandName(cmd));
+	RecordCommand(tile, p1, p2, cmd & ~CMD_NETWORK_COMMAND, text);
 
 	/* Actually try and execute the command. If no cost-type is given
 	 * use the construction one */
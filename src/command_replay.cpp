@@ -0,0 +1,501 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file command_replay.cpp Recording of the executed commands, and replaying them as fast as possible.
+ *
+ * A recording starts with a savegame, followed by every command that was
+ * executed together with the tick it was executed in. Replaying it loads the
+ * savegame and executes the commands at the same ticks again, while the AIs
+ * and game script do not run, which makes it a reproducible benchmark.
+ *
+ * Commands the game itself executes during a tick, like starting a new AI
+ * company or closing a bankrupt one, are not recorded; the replay executes
+ * them itself. In a network game those went through the command queue
+ * though, so they are recorded and the replay skips the game's own ones.
+ * At the end of the recording the state of the game is hashed, so the
+ * replay can check it ended up in the same state.
+ */
+
+#include "stdafx.h"
+#include "command_replay.h"
+#include "command_func.h"
+#include "company_func.h"
+#include "console_func.h"
+#include "date_type.h"
+#include "debug.h"
+#include "fileio_func.h"
+#include "openttd.h"
+#include "string_func.h"
+#include "core/backup_type.hpp"
+#include "core/random_func.hpp"
+#include "saveload/saveload.h"
+#include "saveload/saveload_filter.h"
+#include "network/network.h"
+#include "network/network_internal.h"
+
+#include "table/strings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "safeguards.h"
+
+extern bool SafeLoad(const char *filename, SaveLoadOperation fop, DetailedFileType dft, GameMode newgm, Subdirectory subdir, struct LoadFilter *lf = nullptr);
+extern void StateGameLoop();
+
+/** Identifier at the start of every command recording. */
+static const char COMMAND_RECORDING_MAGIC[4] = { 'O', 'T', 'C', 'R' };
+/** Version of the format of the command recordings. */
+static const uint32 COMMAND_RECORDING_VERSION = 2;
+/** Every how many ticks the state of the random generator is recorded, to check whether the replay is still in sync. */
+static const uint32 COMMAND_RECORDING_SYNC_INTERVAL = DAY_TICKS;
+
+/** Types of the records of a command recording. */
+enum CommandRecordType {
+	CRT_COMMAND, ///< A command that was executed.
+	CRT_SYNC,    ///< The state of the random generator at the start of a tick.
+	CRT_END,     ///< The end of the recording, with the state of the game at that moment.
+};
+
+/** A record of a command recording, as read while replaying. */
+struct CommandRecord {
+	CommandRecordType type;   ///< The type of the record.
+	uint32 tick;              ///< The tick of the record.
+	CommandReplayPhase phase; ///< When within the tick the command was executed.
+	CompanyID company;        ///< The company that executed the command.
+	CommandContainer cmd;     ///< The command.
+	uint32 random[2];         ///< The state of the random generator.
+	uint32 hashes[NSH_END];   ///< The hashes of the game state at the end of the recording.
+	bool complete;            ///< Whether the record could be read completely.
+};
+
+CommandReplayPhase _command_replay_phase = CRP_BETWEEN_TICKS; ///< The part of the tick the game is currently in.
+
+static uint32 _command_replay_tick;           ///< The number of ticks since the recording or the replay started.
+static FILE *_command_recording = nullptr;    ///< The file the commands are recorded to, if we are recording.
+static FILE *_command_replay = nullptr;       ///< The file the commands are replayed from, if we are replaying.
+static bool _command_replay_networked;        ///< Whether the replayed commands were recorded in a network game.
+static CommandRecord _command_replay_record;  ///< The next record to replay.
+static uint _command_replay_commands;         ///< The number of replayed commands.
+static uint _command_replay_sync_errors;      ///< The number of times the replay was found to be out of sync.
+
+/** Writes the savegame at the start of a command recording. */
+struct CommandRecordingWriter : SaveFilter {
+	FILE *file; ///< The file of the recording, which stays open after the savegame is written.
+
+	/**
+	 * Create the writer.
+	 * @param file The file of the recording.
+	 */
+	CommandRecordingWriter(FILE *file) : SaveFilter(nullptr), file(file)
+	{
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		if (fwrite(buf, 1, size, this->file) != size) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_WRITEABLE);
+	}
+};
+
+/** Reads the savegame at the start of a command recording. */
+struct CommandReplayReader : LoadFilter {
+	FILE *file;       ///< The file of the recording, which stays open after the savegame is read.
+	long begin;       ///< The position of the savegame in the file.
+	size_t size;      ///< The size of the savegame.
+	size_t remaining; ///< The number of bytes of the savegame that have not been read yet.
+
+	/**
+	 * Create the reader, for the savegame at the current position in the file.
+	 * @param file The file of the recording.
+	 * @param size The size of the savegame.
+	 */
+	CommandReplayReader(FILE *file, size_t size) : LoadFilter(nullptr), file(file), begin(ftell(file)), size(size), remaining(size)
+	{
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size_t len = fread(buf, 1, min(size, this->remaining), this->file);
+		this->remaining -= len;
+		return len;
+	}
+
+	void Reset() override
+	{
+		clearerr(this->file);
+		if (fseek(this->file, this->begin, SEEK_SET)) {
+			DEBUG(sl, 1, "Could not reset the file reading");
+		}
+		this->remaining = this->size;
+	}
+};
+
+/**
+ * Write a byte to a command recording.
+ * @param f The file of the recording.
+ * @param value The value to write.
+ */
+static void WriteUint8(FILE *f, uint8 value)
+{
+	fputc(value, f);
+}
+
+/**
+ * Write a 32 bits integer to a command recording, in little endian.
+ * @param f The file of the recording.
+ * @param value The value to write.
+ */
+static void WriteUint32(FILE *f, uint32 value)
+{
+	for (uint i = 0; i < 32; i += 8) fputc(GB(value, i, 8), f);
+}
+
+/**
+ * Read a byte from a command recording.
+ * @param f The file of the recording.
+ * @param[out] value The read value.
+ * @return Whether the value could be read.
+ */
+static bool ReadUint8(FILE *f, uint8 *value)
+{
+	int c = fgetc(f);
+	if (c == EOF) return false;
+	*value = (uint8)c;
+	return true;
+}
+
+/**
+ * Read a 32 bits integer from a command recording.
+ * @param f The file of the recording.
+ * @param[out] value The read value.
+ * @return Whether the value could be read.
+ */
+static bool ReadUint32(FILE *f, uint32 *value)
+{
+	byte buf[4];
+	if (fread(buf, 1, sizeof(buf), f) != sizeof(buf)) return false;
+	*value = buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32)buf[3] << 24;
+	return true;
+}
+
+/**
+ * Start recording the executed commands. The recording starts with a savegame of the current game.
+ * @param filename The name of the file to record to, in the savegame directory.
+ * @return Whether the recording could be started.
+ */
+bool StartCommandRecording(const char *filename)
+{
+	StopCommandRecording();
+
+	FILE *f = FioFOpenFile(filename, "wb", SAVE_DIR);
+	if (f == nullptr) return false;
+
+	fwrite(COMMAND_RECORDING_MAGIC, 1, sizeof(COMMAND_RECORDING_MAGIC), f);
+	WriteUint32(f, COMMAND_RECORDING_VERSION);
+	WriteUint8(f, _networking ? 1 : 0);
+
+	/* The size of the savegame is only known after writing it. */
+	long size_pos = ftell(f);
+	WriteUint32(f, 0);
+	if (SaveWithFilter(new CommandRecordingWriter(f), false) != SL_OK) {
+		fclose(f);
+		return false;
+	}
+	long end = ftell(f);
+	fseek(f, size_pos, SEEK_SET);
+	WriteUint32(f, (uint32)(end - size_pos - 4));
+	fseek(f, end, SEEK_SET);
+
+	_command_recording = f;
+	_command_replay_tick = 0;
+	return true;
+}
+
+/**
+ * Hash the whole state of the game, to compare the end of a replay with the end of the recording.
+ * @param[out] hashes The hashes of the parts of the game state.
+ */
+static void CalculateEndStateHashes(uint32 hashes[NSH_END])
+{
+	NetworkCalculateSyncHashes(0, hashes);
+
+	/* The sync hashes only cover one region of the map, so combine those of all regions. */
+	for (uint region = 1; region < NETWORK_SYNC_HASH_MAP_REGIONS; region++) {
+		uint32 region_hashes[NSH_END];
+		NetworkCalculateSyncHashes(region, region_hashes);
+		hashes[NSH_MAP] = ROL(hashes[NSH_MAP], 1) ^ region_hashes[NSH_MAP];
+	}
+}
+
+/** Stop recording the executed commands, if we are recording. */
+void StopCommandRecording()
+{
+	if (_command_recording == nullptr) return;
+
+	uint32 hashes[NSH_END];
+	CalculateEndStateHashes(hashes);
+
+	WriteUint8(_command_recording, CRT_END);
+	WriteUint32(_command_recording, _command_replay_tick);
+	WriteUint32(_command_recording, _random.state[0]);
+	WriteUint32(_command_recording, _random.state[1]);
+	for (uint i = 0; i < NSH_END; i++) WriteUint32(_command_recording, hashes[i]);
+
+	bool ok = ferror(_command_recording) == 0;
+	if (fclose(_command_recording) != 0) ok = false;
+	_command_recording = nullptr;
+
+	if (ok) {
+		IConsolePrintF(CC_DEFAULT, "Recorded %u ticks of commands", _command_replay_tick);
+	} else {
+		IConsolePrint(CC_ERROR, "Writing the command recording failed");
+	}
+}
+
+/**
+ * Are we recording the executed commands?
+ * @return True when recording.
+ */
+bool IsRecordingCommands()
+{
+	return _command_recording != nullptr;
+}
+
+/**
+ * Record a command that is about to be executed by the current company, if we are recording.
+ * Commands the game itself executes during a tick are not recorded.
+ * @param tile The tile to perform the command on.
+ * @param p1 Additional data for the command.
+ * @param p2 Additional data for the command.
+ * @param cmd The command, without flags.
+ * @param text The text passed to the command, may be \c nullptr.
+ */
+void RecordCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, const char *text)
+{
+	if (_command_recording == nullptr || _command_replay_phase == CRP_GAME_LOOP) return;
+
+	size_t len = text == nullptr ? 0 : min(strlen(text), sizeof(CommandContainer::text) - 1);
+
+	WriteUint8(_command_recording, CRT_COMMAND);
+	WriteUint32(_command_recording, _command_replay_tick);
+	WriteUint8(_command_recording, _command_replay_phase);
+	WriteUint8(_command_recording, _current_company);
+	WriteUint32(_command_recording, tile);
+	WriteUint32(_command_recording, p1);
+	WriteUint32(_command_recording, p2);
+	WriteUint32(_command_recording, cmd);
+	WriteUint8(_command_recording, (uint8)len);
+	fwrite(text, 1, len, _command_recording);
+}
+
+/** Read the next record to replay; a damaged or incomplete recording simply ends. */
+static void ReadNextCommandRecord()
+{
+	CommandRecord &r = _command_replay_record;
+	FILE *f = _command_replay;
+
+	uint8 type, phase = 0, company = 0, len = 0;
+	bool ok = ReadUint8(f, &type) && ReadUint32(f, &r.tick);
+	if (ok && type == CRT_COMMAND) {
+		ok = ReadUint8(f, &phase) && ReadUint8(f, &company) && ReadUint32(f, &r.cmd.tile) &&
+				ReadUint32(f, &r.cmd.p1) && ReadUint32(f, &r.cmd.p2) && ReadUint32(f, &r.cmd.cmd) &&
+				ReadUint8(f, &len) && len < sizeof(r.cmd.text) && fread(r.cmd.text, 1, len, f) == len;
+		r.phase = (CommandReplayPhase)phase;
+		r.company = (CompanyID)company;
+		r.cmd.cmd |= CMD_NETWORK_COMMAND;
+		r.cmd.callback = nullptr;
+		r.cmd.text[ok ? len : 0] = '\0';
+	} else if (ok && type == CRT_SYNC) {
+		ok = ReadUint32(f, &r.random[0]) && ReadUint32(f, &r.random[1]);
+	} else if (ok && type == CRT_END) {
+		ok = ReadUint32(f, &r.random[0]) && ReadUint32(f, &r.random[1]);
+		for (uint i = 0; ok && i < NSH_END; i++) ok = ReadUint32(f, &r.hashes[i]);
+	} else if (ok) {
+		ok = false;
+	}
+
+	if (!ok) {
+		DEBUG(misc, 0, "The command recording is incomplete");
+		type = CRT_END;
+		r.tick = 0;
+	}
+	r.type = (CommandRecordType)type;
+	r.complete = ok;
+}
+
+/**
+ * Are we replaying recorded commands?
+ * @return True when replaying.
+ */
+bool IsReplayingCommands()
+{
+	return _command_replay != nullptr;
+}
+
+/**
+ * Execute the recorded commands of the current tick that were executed at the given moment within the tick.
+ * @param phase The moment within the tick.
+ */
+void ReplayCommands(CommandReplayPhase phase)
+{
+	const CommandRecord &r = _command_replay_record;
+	while (r.type == CRT_COMMAND && r.tick == _command_replay_tick && r.phase == phase) {
+		Backup<CompanyID> cur_company(_current_company, r.company, FILE_LINE);
+		DoCommandP(&r.cmd, false);
+		cur_company.Restore();
+
+		_command_replay_commands++;
+		ReadNextCommandRecord();
+	}
+}
+
+/**
+ * Should a command the game itself executes during the tick be skipped while replaying?
+ * In a network game such commands went through the command queue, so the
+ * recording contains them as commands that were executed between the ticks.
+ * @param cmd The command that is about to be executed.
+ * @return True when the command must not be executed.
+ */
+bool SkipCommandDuringReplay(uint32 cmd)
+{
+	return _command_replay != nullptr && _command_replay_networked && _command_replay_phase == CRP_GAME_LOOP && (cmd & CMD_NETWORK_COMMAND) == 0;
+}
+
+/**
+ * Keep track of the ticks while recording or replaying commands; called at the start of every tick.
+ * Every now and then the state of the random generator is recorded, or compared with the recorded one.
+ */
+void CommandReplayTick()
+{
+	if (_command_recording == nullptr && _command_replay == nullptr) return;
+
+	_command_replay_tick++;
+	if (_command_replay_tick % COMMAND_RECORDING_SYNC_INTERVAL != 0) return;
+
+	if (_command_recording != nullptr) {
+		WriteUint8(_command_recording, CRT_SYNC);
+		WriteUint32(_command_recording, _command_replay_tick);
+		WriteUint32(_command_recording, _random.state[0]);
+		WriteUint32(_command_recording, _random.state[1]);
+		return;
+	}
+
+	const CommandRecord &r = _command_replay_record;
+	if (r.type != CRT_SYNC || r.tick != _command_replay_tick) return;
+
+	if (r.random[0] != _random.state[0] || r.random[1] != _random.state[1]) {
+		if (_command_replay_sync_errors == 0) IConsolePrintF(CC_ERROR, "The replay is out of sync at tick %u", _command_replay_tick);
+		_command_replay_sync_errors++;
+	}
+	ReadNextCommandRecord();
+}
+
+/**
+ * Replay a command recording as fast as possible, and report how long the ticks took.
+ * @param filename The name of the recording.
+ * @return Whether the replay was in sync with the recording.
+ */
+bool RunCommandReplay(const char *filename)
+{
+	FILE *f = FioFOpenFile(filename, "rb", SAVE_DIR);
+	if (f == nullptr) {
+		IConsolePrintF(CC_ERROR, "Cannot open the command recording %s", filename);
+		return false;
+	}
+
+	char magic[sizeof(COMMAND_RECORDING_MAGIC)];
+	uint32 version, size;
+	uint8 networked;
+	if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, COMMAND_RECORDING_MAGIC, sizeof(magic)) != 0 ||
+			!ReadUint32(f, &version) || version != COMMAND_RECORDING_VERSION || !ReadUint8(f, &networked) || !ReadUint32(f, &size)) {
+		IConsolePrintF(CC_ERROR, "%s is not a command recording", filename);
+		fclose(f);
+		return false;
+	}
+
+	long begin = ftell(f);
+	if (!SafeLoad(nullptr, SLO_LOAD, DFT_GAME_FILE, GM_NORMAL, NO_DIRECTORY, new CommandReplayReader(f, size))) {
+		IConsolePrint(CC_ERROR, "Loading the savegame of the command recording failed");
+		fclose(f);
+		return false;
+	}
+	SetLocalCompany(COMPANY_SPECTATOR);
+	fseek(f, begin + size, SEEK_SET);
+
+	_command_replay = f;
+	_command_replay_networked = networked != 0;
+	_command_replay_tick = 0;
+	_command_replay_commands = 0;
+	_command_replay_sync_errors = 0;
+	ReadNextCommandRecord();
+
+	std::vector<uint32> tick_times;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (;;) {
+		ReplayCommands(CRP_BETWEEN_TICKS);
+
+		const CommandRecord &r = _command_replay_record;
+		if (r.type == CRT_END && r.tick <= _command_replay_tick) break;
+		if (r.tick <= _command_replay_tick) {
+			IConsolePrintF(CC_ERROR, "The replay is out of sync at tick %u; not all commands of the tick could be replayed", _command_replay_tick);
+			_command_replay_sync_errors++;
+			break;
+		}
+
+		std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+		StateGameLoop();
+		uint32 us = (uint32)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tick_start).count();
+		tick_times.push_back(us);
+		DEBUG(misc, 3, "Replayed tick %u in %u us", _command_replay_tick, us);
+	}
+	double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	/* Check whether the replay ended in the same state as the recording. */
+	const CommandRecord &r = _command_replay_record;
+	if (r.type == CRT_END && r.complete && r.tick == _command_replay_tick) {
+		static const char * const names[] = { "map", "companies", "vehicles", "stations" };
+		assert_compile(lengthof(names) == NSH_END);
+
+		uint32 hashes[NSH_END];
+		CalculateEndStateHashes(hashes);
+
+		bool same = r.random[0] == _random.state[0] && r.random[1] == _random.state[1];
+		for (uint i = 0; i < NSH_END; i++) {
+			if (r.hashes[i] == hashes[i]) continue;
+			IConsolePrintF(CC_ERROR, "The replay ended with a different state of the %s", names[i]);
+			same = false;
+		}
+		if (!same) {
+			IConsolePrint(CC_ERROR, "The replay did not end in the same state as the recording");
+			_command_replay_sync_errors++;
+		}
+	}
+
+	fclose(f);
+	_command_replay = nullptr;
+
+	if (tick_times.empty()) {
+		IConsolePrint(CC_WARNING, "The command recording does not contain any ticks");
+	} else {
+		uint64 sum = 0;
+		for (uint32 us : tick_times) sum += us;
+		std::sort(tick_times.begin(), tick_times.end());
+
+		IConsolePrintF(CC_DEFAULT, "Replayed %u ticks and %u commands in %.3f seconds (%.1f ticks per second)",
+				(uint)tick_times.size(), _command_replay_commands, total, tick_times.size() / max(total, 1e-9));
+		IConsolePrintF(CC_DEFAULT, "Tick times: mean %.3f ms, median %.3f ms, 99th percentile %.3f ms, maximum %.3f ms",
+				sum / 1000.0 / tick_times.size(), tick_times[tick_times.size() / 2] / 1000.0,
+				tick_times[tick_times.size() * 99 / 100] / 1000.0, tick_times.back() / 1000.0);
+	}
+	if (_command_replay_sync_errors != 0) IConsolePrintF(CC_ERROR, "The replay was out of sync %u times", _command_replay_sync_errors);
+
+	return _command_replay_sync_errors == 0;
+}
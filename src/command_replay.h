@@ -0,0 +1,38 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file command_replay.h Functions for recording the executed commands and replaying them. */
+
+#ifndef COMMAND_REPLAY_H
+#define COMMAND_REPLAY_H
+
+#include "tile_type.h"
+
+/** The moments within a tick at which recorded commands are executed. */
+enum CommandReplayPhase {
+	CRP_BETWEEN_TICKS, ///< Between the ticks, i.e. by the players or from the network.
+	CRP_SCRIPTS,       ///< During the tick, by the AIs and game script.
+	CRP_GAME_LOOP,     ///< During the tick, by the game itself; these are not recorded as the replay executes them itself.
+};
+
+extern CommandReplayPhase _command_replay_phase;
+
+bool StartCommandRecording(const char *filename);
+void StopCommandRecording();
+bool IsRecordingCommands();
+void RecordCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, const char *text);
+
+bool RunCommandReplay(const char *filename);
+bool IsReplayingCommands();
+void ReplayCommands(CommandReplayPhase phase);
+bool SkipCommandDuringReplay(uint32 cmd);
+
+void CommandReplayTick();
+
+#endif /* COMMAND_REPLAY_H */
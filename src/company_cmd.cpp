@@ -36,6 +36,7 @@
 #include "game/game.hpp"
 #include "goal_base.h"
 #include "story_base.h"
+#include "command_replay.h"
 
 #include "table/strings.h"
 
@@ -820,8 +821,8 @@ CommandCost CmdCompanyCtrl(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 
 	switch ((CompanyCtrlAction)GB(p1, 0, 16)) {
 		case CCA_NEW: { // Create a new company
-			/* This command is only executed in a multiplayer game */
-			if (!_networking) return CMD_ERROR;
+			/* This command is only executed in a multiplayer game, or when replaying one */
+			if (!_networking && !IsReplayingCommands()) return CMD_ERROR;
 
 			/* Has the network client a correct ClientIndex? */
 			if (!(flags & DC_EXEC)) return CommandCost();
@@ -833,7 +834,7 @@ CommandCost CmdCompanyCtrl(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 			 * are actually no clients at all. However, the company has to
 			 * be created, otherwise we cannot rerun the game properly.
 			 * So only allow a nullptr client info in that case. */
-			if (ci == nullptr) return CommandCost();
+			if (ci == nullptr && !IsReplayingCommands()) return CommandCost();
 #endif /* NOT DEBUG_DUMP_COMMANDS */
 
 			/* Delete multiplayer progress bar */
@@ -851,7 +852,7 @@ CommandCost CmdCompanyCtrl(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 			}
 
 			/* This is the client (or non-dedicated server) who wants a new company */
-			if (client_id == _network_own_client_id) {
+			if (client_id == _network_own_client_id && !IsReplayingCommands()) {
 				assert(_local_company == COMPANY_SPECTATOR);
 				SetLocalCompany(c->index);
 				if (!StrEmpty(_settings_client.network.default_company_pass)) {
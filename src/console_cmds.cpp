@@ -38,6 +38,7 @@
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "command_replay.h"
 #include "table/strings.h"
 
 #include "safeguards.h"
@@ -320,6 +321,48 @@ DEF_CONSOLE_CMD(ConSave)
 	return false;
 }
 
+DEF_CONSOLE_CMD(ConStartRecording)
+{
+	if (argc == 0) {
+		IConsoleHelp("Record the current game and all commands executed from now on, to replay them with 'openttd -R'. Usage: 'startrecording <filename>'");
+		return true;
+	}
+
+	if (argc == 2) {
+		if (_game_mode != GM_NORMAL) {
+			IConsoleError("Only games can be recorded.");
+			return true;
+		}
+
+		char *filename = str_fmt("%s.rec", argv[1]);
+		if (!StartCommandRecording(filename)) {
+			IConsolePrint(CC_ERROR, "Starting the recording failed");
+		} else {
+			IConsolePrintF(CC_DEFAULT, "Recording commands to %s", filename);
+		}
+		free(filename);
+		return true;
+	}
+
+	return false;
+}
+
+DEF_CONSOLE_CMD(ConStopRecording)
+{
+	if (argc == 0) {
+		IConsoleHelp("Stop recording commands. Usage: 'stoprecording'");
+		return true;
+	}
+
+	if (!IsRecordingCommands()) {
+		IConsoleError("Not recording any commands.");
+		return true;
+	}
+
+	StopCommandRecording();
+	return true;
+}
+
 /**
  * Explicitly save the configuration.
  * @return True.
@@ -1937,6 +1980,8 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("rm",           ConRemove);
 	IConsoleCmdRegister("save",         ConSave);
 	IConsoleCmdRegister("saveconfig",   ConSaveConfig);
+	IConsoleCmdRegister("startrecording", ConStartRecording);
+	IConsoleCmdRegister("stoprecording", ConStopRecording);
 	IConsoleCmdRegister("ls",           ConListFiles);
 	IConsoleCmdRegister("cd",           ConChangeDirectory);
 	IConsoleCmdRegister("pwd",          ConPrintWorkingDirectory);
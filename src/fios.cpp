@@ -17,6 +17,7 @@
 #include "fileio_func.h"
 #include "fios.h"
 #include "network/network_content.h"
+#include "saveload/saveload.h"
 #include "screenshot.h"
 #include "string_func.h"
 #include "tar_type.h"
@@ -463,6 +464,26 @@ FiosType FiosGetSavegameListCallback(SaveLoadOperation fop, const char *file, co
 	return FIOS_TYPE_INVALID;
 }
 
+/**
+ * Get the summary of a savegame, i.e. its date, map size, companies and NewGRFs, without loading the savegame.
+ * @param file    Name of the savegame.
+ * @param subdir  Directory to search the savegame in, when it is not an absolute path.
+ * @param summary Destination of the summary.
+ * @return False when the savegame does not exist or has no summary (e.g. saved by an older version).
+ */
+bool FiosGetSavegameSummary(const char *file, Subdirectory subdir, SavegameSummary *summary)
+{
+	char path[MAX_PATH];
+	if (FioFindFullPath(path, lastof(path), subdir, file) == nullptr) strecpy(path, file, lastof(path));
+
+	FILE *f = FioFOpenFile(path, "rb", NO_DIRECTORY);
+	if (f == nullptr) return false;
+
+	bool valid = ReadSavegameSummary(f, summary);
+	FioFCloseFile(f);
+	return valid;
+}
+
 /**
  * Get a list of savegames.
  * @param fop Purpose of collecting the list.
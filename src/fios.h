@@ -16,6 +16,8 @@
 #include "company_base.h"
 #include "newgrf_config.h"
 #include "network/core/tcp_content.h"
+#include <string>
+#include <vector>
 
 
 /** Special values for save-load window for the data parameter of #InvalidateWindowData. */
@@ -85,6 +87,40 @@ struct LoadCheckData {
 
 extern LoadCheckData _load_check_data;
 
+/** A company as stored in a savegame summary. */
+struct SavegameSummaryCompany {
+	CompanyID index;                              ///< Index of the company.
+	Year inaugurated_year;                        ///< Year of starting the company.
+	Money money;                                  ///< Money owned by the company.
+	std::string name;                             ///< Name of the company.
+};
+
+/** A NewGRF as stored in a savegame summary. */
+struct SavegameSummaryGRF {
+	uint32 grfid;                                 ///< GRF ID of the NewGRF.
+	uint8 md5sum[16];                             ///< MD5 checksum of the NewGRF the game was saved with.
+	std::string filename;                         ///< Filename of the NewGRF.
+};
+
+/**
+ * Summary of a savegame. It is stored uncompressed in front of the savegame
+ * data, so it can be read without loading or decompressing the savegame.
+ */
+struct SavegameSummary {
+	uint16 version;                               ///< Savegame version.
+	Date date;                                    ///< Date of the game.
+	uint32 map_size_x, map_size_y;                ///< Size of the map.
+
+	uint32 last_ottd_rev;                         ///< Last OpenTTD revision (NewGRF version) the game was played with.
+	byte ever_modified;                           ///< Highest modified state from the gamelog.
+	bool removed_newgrfs;                         ///< Whether NewGRFs have ever been removed from the game.
+
+	std::vector<SavegameSummaryCompany> companies; ///< Companies in the game.
+	std::vector<SavegameSummaryGRF> grfs;         ///< NewGRFs used by the game.
+};
+
+bool FiosGetSavegameSummary(const char *file, Subdirectory subdir, SavegameSummary *summary);
+
 
 enum FileSlots {
 	/**
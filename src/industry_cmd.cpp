@@ -1863,6 +1863,7 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 	}
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, 0);
 
+	AddAcceptanceTilesToStations(i->location);
 	if (!_generating_world) PopulateStationsNearby(i);
 }
 
@@ -34,10 +34,27 @@
 	const Order *first = v->orders.list->GetNextDecisionNode(v->GetOrder(v->cur_implicit_order_index), 0);
 	if (first == nullptr) return;
 
+	uint8 flags = v->last_loading_station != INVALID_STATION ? 1 << HAS_CARGO : 0;
+
+	/* Unless refits are involved the predicted links only depend on the
+	 * orders, so consists sharing them can reuse an earlier prediction.
+	 * Only the stats are refreshed with their own capacities then. */
+	const LinkRefreshPrediction *prediction = v->orders.list->GetLinkRefreshPrediction(first, flags);
+	if (prediction != nullptr) {
+		LinkRefresher refresher(v, nullptr, nullptr, allow_merge, is_full_loading);
+		for (LinkRefreshPrediction::const_iterator it(prediction->begin()); it != prediction->end(); ++it) {
+			refresher.RefreshStats(it->first, it->second);
+		}
+		return;
+	}
+
 	HopSet seen_hops;
-	LinkRefresher refresher(v, &seen_hops, allow_merge, is_full_loading);
+	Recording recording;
+	LinkRefresher refresher(v, &seen_hops, &recording, allow_merge, is_full_loading);
 
-	refresher.RefreshLinks(first, first, v->last_loading_station != INVALID_STATION ? 1 << HAS_CARGO : 0);
+	refresher.RefreshLinks(first, first, flags);
+
+	if (recording.valid) v->orders.list->SetLinkRefreshPrediction(first, flags, recording.links);
 }
 
 /**
@@ -65,11 +82,13 @@ bool LinkRefresher::Hop::operator<(const Hop &other) const
  * @param vehicle Vehicle to refresh links for.
  * @param seen_hops Set of hops already seen. This is shared between this
  *                  refresher and all its children.
+ * @param recording Recording of the refreshed links. This is shared between
+ *                  this refresher and all its children.
  * @param allow_merge If the refresher is allowed to merge or extend link graphs.
  * @param is_full_loading If the vehicle is full loading.
  */
-LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, bool allow_merge, bool is_full_loading) :
-	vehicle(vehicle), seen_hops(seen_hops), cargo(CT_INVALID), allow_merge(allow_merge),
+LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, Recording *recording, bool allow_merge, bool is_full_loading) :
+	vehicle(vehicle), seen_hops(seen_hops), recording(recording), cargo(CT_INVALID), allow_merge(allow_merge),
 	is_full_loading(is_full_loading)
 {
 	memset(this->capacities, 0, sizeof(this->capacities));
@@ -91,6 +110,9 @@ LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, bool allow_mer
  */
 bool LinkRefresher::HandleRefit(CargoID refit_cargo)
 {
+	/* Refit capacities depend on the consist; the result can't be shared. */
+	if (this->recording != nullptr) this->recording->valid = false;
+
 	this->cargo = refit_cargo;
 	RefitList::iterator refit_it = this->refit_capacities.begin();
 	bool any_refit = false;
@@ -202,6 +224,8 @@ const Order *LinkRefresher::PredictNextOrder(const Order *cur, const Order *next
  */
 void LinkRefresher::RefreshStats(const Order *cur, const Order *next)
 {
+	if (this->recording != nullptr) this->recording->links.push_back(std::make_pair(cur, next));
+
 	StationID next_station = next->GetDestination();
 	Station *st = Station::GetIfValid(cur->GetDestination());
 	if (st != nullptr && next_station != INVALID_STATION && next_station != st->index) {
@@ -82,15 +82,27 @@ protected:
 	typedef std::vector<RefitDesc> RefitList;
 	typedef std::set<Hop> HopSet;
 
+	/**
+	 * Links recorded during a run, to be cached in the order list. Shared
+	 * between all Refreshers of the same run.
+	 */
+	struct Recording {
+		LinkRefreshPrediction links; ///< Links refreshed so far, in order.
+		bool valid;                  ///< If the links don't depend on the consist, i.e. there was no refit.
+
+		Recording() : valid(true) {}
+	};
+
 	Vehicle *vehicle;           ///< Vehicle for which the links should be refreshed.
 	uint capacities[NUM_CARGO]; ///< Current added capacities per cargo ID in the consist.
 	RefitList refit_capacities; ///< Current state of capacity remaining from previous refits versus overall capacity per vehicle in the consist.
 	HopSet *seen_hops;          ///< Hops already seen. If the same hop is seen twice we stop the algorithm. This is shared between all Refreshers of the same run.
+	Recording *recording;       ///< Recording of the refreshed links or nullptr if a cached prediction is used.
 	CargoID cargo;              ///< Cargo given in last refit order.
 	bool allow_merge;           ///< If the refresher is allowed to merge or extend link graphs.
 	bool is_full_loading;       ///< If the vehicle is full loading.
 
-	LinkRefresher(Vehicle *v, HopSet *seen_hops, bool allow_merge, bool is_full_loading);
+	LinkRefresher(Vehicle *v, HopSet *seen_hops, Recording *recording, bool allow_merge, bool is_full_loading);
 
 	bool HandleRefit(CargoID refit_cargo);
 	void ResetRefit();
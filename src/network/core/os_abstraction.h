@@ -56,6 +56,7 @@ typedef unsigned long in_addr_t;
 #	include <unistd.h>
 #	include <sys/ioctl.h>
 #	include <sys/socket.h>
+#	include <sys/uio.h>
 #	include <netinet/in.h>
 #	include <netinet/tcp.h>
 #	include <arpa/inet.h>
@@ -80,6 +81,11 @@ typedef unsigned long in_addr_t;
 #	include <errno.h>
 #	include <sys/time.h>
 #	include <netdb.h>
+#	if defined(__linux__)
+#		include <poll.h>
+#		include <sys/epoll.h>
+#		define HAVE_EPOLL
+#	endif
 #endif /* UNIX */
 
 /* OS/2 stuff */
@@ -16,8 +16,85 @@
 
 #include "packet.h"
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "../../safeguards.h"
 
+/**
+ * Header in front of the data of every packet. The data is reference counted,
+ * so the same packet can be queued on many sockets without copying it, and
+ * the buffers are recycled instead of freed after sending.
+ */
+struct PacketBuffer {
+	std::atomic<uint32> refs; ///< Number of packets using this buffer.
+	uint8 size_class;         ///< Index of the size of this buffer in #_packet_buffer_sizes.
+};
+
+/** The sizes of the pooled buffers; most packets that are sent are tiny. */
+static const size_t _packet_buffer_sizes[] = { 64, 256, SEND_MTU };
+/** The maximum number of free buffers to keep per size. */
+static const size_t PACKET_BUFFER_POOL_MAX = 1024;
+
+static std::mutex _packet_buffer_pool_mutex; ///< Mutex for the pool, as packets are also made by the UDP threads.
+static std::vector<PacketBuffer *> _packet_buffer_pool[lengthof(_packet_buffer_sizes)]; ///< The free buffers per size.
+
+/**
+ * Get a buffer for a packet from the pool.
+ * @param size_class The index of the size of the buffer in #_packet_buffer_sizes.
+ * @return The data of the buffer, with a reference count of one.
+ */
+static byte *AllocatePacketBuffer(uint8 size_class)
+{
+	PacketBuffer *pb = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(_packet_buffer_pool_mutex);
+		std::vector<PacketBuffer *> &pool = _packet_buffer_pool[size_class];
+		if (!pool.empty()) {
+			pb = pool.back();
+			pool.pop_back();
+		}
+	}
+
+	if (pb == nullptr) {
+		pb = new (MallocT<byte>(sizeof(PacketBuffer) + _packet_buffer_sizes[size_class])) PacketBuffer();
+		pb->size_class = size_class;
+	}
+	pb->refs.store(1, std::memory_order_relaxed);
+	return (byte *)(pb + 1);
+}
+
+/**
+ * Get the header of the buffer of a packet.
+ * @param buffer The data of the buffer.
+ * @return The header.
+ */
+static inline PacketBuffer *GetPacketBuffer(byte *buffer)
+{
+	return (PacketBuffer *)buffer - 1;
+}
+
+/**
+ * Drop a reference to the buffer of a packet, and give it back to the pool
+ * when it is not used anymore.
+ * @param buffer The data of the buffer.
+ */
+static void ReleasePacketBuffer(byte *buffer)
+{
+	PacketBuffer *pb = GetPacketBuffer(buffer);
+	if (pb->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+	std::lock_guard<std::mutex> lock(_packet_buffer_pool_mutex);
+	std::vector<PacketBuffer *> &pool = _packet_buffer_pool[pb->size_class];
+	if (pool.size() < PACKET_BUFFER_POOL_MAX) {
+		pool.push_back(pb);
+	} else {
+		pb->~PacketBuffer();
+		free(pb);
+	}
+}
+
 /**
  * Create a packet that is used to read from a network socket
  * @param cs the socket handler associated with the socket we are reading from
@@ -30,7 +107,10 @@ Packet::Packet(NetworkSocketHandler *cs)
 	this->next   = nullptr;
 	this->pos    = 0; // We start reading from here
 	this->size   = 0;
-	this->buffer = MallocT<byte>(SEND_MTU);
+	this->buffer = AllocatePacketBuffer(lengthof(_packet_buffer_sizes) - 1);
+	this->payload      = nullptr;
+	this->payload_size = 0;
+	this->payload_pos  = 0;
 }
 
 /**
@@ -45,16 +125,72 @@ Packet::Packet(PacketType type)
 	/* Skip the size so we can write that in before sending the packet */
 	this->pos                  = 0;
 	this->size                 = sizeof(PacketSize);
-	this->buffer               = MallocT<byte>(SEND_MTU);
+	this->buffer               = AllocatePacketBuffer(lengthof(_packet_buffer_sizes) - 1);
 	this->buffer[this->size++] = type;
+	this->payload              = nullptr;
+	this->payload_size         = 0;
+	this->payload_pos          = 0;
 }
 
 /**
- * Free the buffer of this packet.
+ * Creates another packet to send with the same contents, sharing the buffer.
+ * @param shared The packet to share the buffer of.
+ */
+Packet::Packet(const Packet *shared)
+{
+	this->cs           = nullptr;
+	this->next         = nullptr;
+	this->pos          = 0;
+	this->size         = shared->size;
+	this->buffer       = shared->buffer;
+	this->payload      = nullptr;
+	this->payload_size = 0;
+	this->payload_pos  = 0;
+
+	GetPacketBuffer(this->buffer)->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Release the buffer of this packet.
  */
 Packet::~Packet()
 {
-	free(this->buffer);
+	ReleasePacketBuffer(this->buffer);
+}
+
+/**
+ * Create a packet with the same contents as this one, to send the same data
+ * to another socket. The buffer is shared, so neither packet may be written
+ * to anymore.
+ * @return The new packet.
+ */
+Packet *Packet::Share()
+{
+	assert(this->cs == nullptr && this->payload_size == 0);
+
+	this->ShrinkBuffer();
+	return new Packet(this);
+}
+
+/**
+ * Move the contents of the packet to the smallest buffer it fits in, as in
+ * 99+% of the times we send at most 25 bytes and keeping the other 1400+
+ * bytes wastes memory, especially when someone tries to do a denial of
+ * service attack! Shared buffers are left alone, as they are only kept once.
+ */
+void Packet::ShrinkBuffer()
+{
+	PacketBuffer *pb = GetPacketBuffer(this->buffer);
+	if (pb->refs.load(std::memory_order_relaxed) != 1) return;
+
+	uint8 size_class = 0;
+	while (_packet_buffer_sizes[size_class] < this->size) size_class++;
+	if (size_class >= pb->size_class) return;
+
+	byte *buffer = AllocatePacketBuffer(size_class);
+	memcpy(buffer, this->buffer, this->size);
+	ReleasePacketBuffer(this->buffer);
+	this->buffer = buffer;
 }
 
 /**
@@ -68,6 +204,23 @@ void Packet::PrepareToSend()
 	this->buffer[1] = GB(this->size, 8, 8);
 
 	this->pos  = 0; // We start reading from here
+	this->payload_pos = 0;
+}
+
+/**
+ * Send data directly after this packet, without copying it into the packet.
+ * The receiving side must know how much data follows from the packet's contents.
+ * @param payload The data to send; it must not change until the packet is sent.
+ * @param size    The amount of data to send.
+ * @param owner   The owner of the data, which is kept alive until the packet is sent.
+ */
+void Packet::SetPayload(const byte *payload, size_t size, std::shared_ptr<const void> owner)
+{
+	assert(this->cs == nullptr);
+
+	this->payload       = payload;
+	this->payload_size  = size;
+	this->payload_owner = std::move(owner);
 }
 
 /*
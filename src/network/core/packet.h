@@ -50,13 +50,26 @@ struct Packet {
 	PacketSize size;
 	/** The current read/write position in the packet */
 	PacketSize pos;
-	/** The buffer of this packet, of basically variable length up to SEND_MTU. */
+	/** The (possibly shared) buffer of this packet, of basically variable length up to SEND_MTU. */
 	byte *buffer;
+	/**
+	 * Data that is sent directly after the packet, without being copied into
+	 * it or being part of its size; only for packets that will be sent.
+	 */
+	const byte *payload;
+	/** The size of the payload. */
+	size_t payload_size;
+	/** The current send position in the payload. */
+	size_t payload_pos;
+	/** Keeps the payload alive until the packet has been sent. */
+	std::shared_ptr<const void> payload_owner;
 
 private:
 	/** Socket we're associated with. */
 	NetworkSocketHandler *cs;
 
+	Packet(const Packet *shared);
+
 public:
 	Packet(NetworkSocketHandler *cs);
 	Packet(PacketType type);
@@ -64,6 +77,9 @@ public:
 
 	/* Sending/writing of packets */
 	void PrepareToSend();
+	void ShrinkBuffer();
+	Packet *Share();
+	void SetPayload(const byte *payload, size_t size, std::shared_ptr<const void> owner);
 
 	void Send_bool  (bool   data);
 	void Send_uint8 (uint8  data);
@@ -24,8 +24,8 @@
  */
 NetworkTCPSocketHandler::NetworkTCPSocketHandler(SOCKET s) :
 		NetworkSocketHandler(),
-		packet_queue(nullptr), packet_recv(nullptr),
-		sock(s), writable(false)
+		packet_queue(nullptr), packet_queue_last(nullptr), packet_recv(nullptr),
+		raw_data_remaining(0), sock(s), writable(false), poll_events(0)
 {
 }
 
@@ -48,8 +48,10 @@ NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection(bool error)
 		delete this->packet_queue;
 		this->packet_queue = p;
 	}
+	this->packet_queue_last = nullptr;
 	delete this->packet_recv;
 	this->packet_recv = nullptr;
+	this->raw_data_remaining = 0;
 
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -62,26 +64,18 @@ NetworkRecvStatus NetworkTCPSocketHandler::CloseConnection(bool error)
  */
 void NetworkTCPSocketHandler::SendPacket(Packet *packet)
 {
-	Packet *p;
 	assert(packet != nullptr);
 
 	packet->PrepareToSend();
+	packet->ShrinkBuffer();
 
-	/* Reallocate the packet as in 99+% of the times we send at most 25 bytes and
-	 * keeping the other 1400+ bytes wastes memory, especially when someone tries
-	 * to do a denial of service attack! */
-	packet->buffer = ReallocT(packet->buffer, packet->size);
-
-	/* Locate last packet buffered for the client */
-	p = this->packet_queue;
-	if (p == nullptr) {
+	if (this->packet_queue == nullptr) {
 		/* No packets yet */
 		this->packet_queue = packet;
 	} else {
-		/* Skip to the last packet */
-		while (p->next != nullptr) p = p->next;
-		p->next = packet;
+		this->packet_queue_last->next = packet;
 	}
+	this->packet_queue_last = packet;
 }
 
 /**
@@ -96,16 +90,46 @@ void NetworkTCPSocketHandler::SendPacket(Packet *packet)
  */
 SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 {
-	ssize_t res;
-	Packet *p;
-
 	/* We can not write to this socket!! */
 	if (!this->writable) return SPS_NONE_SENT;
 	if (!this->IsConnected()) return SPS_CLOSED;
 
-	p = this->packet_queue;
-	while (p != nullptr) {
-		res = send(this->sock, (const char*)p->buffer + p->pos, p->size - p->pos, 0);
+	while (this->packet_queue != nullptr) {
+		size_t requested = 0;
+		ssize_t res;
+#if defined(UNIX)
+		/* Hand as many of the queued packets and their payloads as possible
+		 * to the kernel at once, straight from their (shared) buffers. */
+		struct iovec iov[64];
+		int iovcnt = 0;
+		for (Packet *p = this->packet_queue; p != nullptr && iovcnt + 2 <= (int)lengthof(iov); p = p->next) {
+			if (p->pos < p->size) {
+				iov[iovcnt].iov_base = p->buffer + p->pos;
+				iov[iovcnt++].iov_len = p->size - p->pos;
+				requested += p->size - p->pos;
+			}
+			if (p->payload_pos < p->payload_size) {
+				iov[iovcnt].iov_base = const_cast<byte *>(p->payload + p->payload_pos);
+				iov[iovcnt++].iov_len = p->payload_size - p->payload_pos;
+				requested += p->payload_size - p->payload_pos;
+			}
+		}
+
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovcnt;
+		res = sendmsg(this->sock, &msg, 0);
+#else
+		Packet *p = this->packet_queue;
+		if (p->pos < p->size) {
+			requested = p->size - p->pos;
+			res = send(this->sock, (const char*)p->buffer + p->pos, (int)requested, 0);
+		} else {
+			requested = min<size_t>(p->payload_size - p->payload_pos, INT_MAX);
+			res = send(this->sock, (const char*)p->payload + p->payload_pos, (int)requested, 0);
+		}
+#endif
 		if (res == -1) {
 			int err = GET_LAST_ERROR();
 			if (err != EWOULDBLOCK) {
@@ -116,6 +140,8 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 				}
 				return SPS_CLOSED;
 			}
+			/* The kernel buffer is full; wait for the socket to become writable again. */
+			this->writable = false;
 			return SPS_PARTLY_SENT;
 		}
 		if (res == 0) {
@@ -124,17 +150,28 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
-		p->pos += res;
+		/* Account the sent data to the packets, and drop the ones that are completely sent. */
+		size_t sent = res;
+		while (sent != 0) {
+			Packet *p = this->packet_queue;
 
-		/* Is this packet sent? */
-		if (p->pos == p->size) {
-			/* Go to the next packet */
-			this->packet_queue = p->next;
-			delete p;
-			p = this->packet_queue;
-		} else {
-			return SPS_PARTLY_SENT;
+			size_t sent_packet = min(sent, (size_t)(p->size - p->pos));
+			p->pos += (PacketSize)sent_packet;
+			sent -= sent_packet;
+
+			size_t sent_payload = min(sent, p->payload_size - p->payload_pos);
+			p->payload_pos += sent_payload;
+			sent -= sent_payload;
+
+			if (p->pos == p->size && p->payload_pos == p->payload_size) {
+				/* Go to the next packet */
+				this->packet_queue = p->next;
+				if (this->packet_queue == nullptr) this->packet_queue_last = nullptr;
+				delete p;
+			}
 		}
+
+		if ((size_t)res < requested) return SPS_PARTLY_SENT;
 	}
 
 	return SPS_ALL_SENT;
@@ -150,6 +187,31 @@ Packet *NetworkTCPSocketHandler::ReceivePacket()
 
 	if (!this->IsConnected()) return nullptr;
 
+	/* The raw data following the previous packet comes before the next packet. */
+	while (this->raw_data_remaining != 0) {
+		byte buf[16384];
+		res = recv(this->sock, (char*)buf, (int)min(this->raw_data_remaining, sizeof(buf)), 0);
+		if (res == -1) {
+			int err = GET_LAST_ERROR();
+			if (err != EWOULDBLOCK) {
+				/* Something went wrong... (104 is connection reset by peer) */
+				if (err != 104) DEBUG(net, 0, "recv failed with error %d", err);
+				this->CloseConnection();
+				return nullptr;
+			}
+			/* Connection would block, so stop for now */
+			return nullptr;
+		}
+		if (res == 0) {
+			/* Client/server has left */
+			this->CloseConnection();
+			return nullptr;
+		}
+
+		this->raw_data_remaining -= res;
+		this->ReceiveRawData(buf, res);
+	}
+
 	if (this->packet_recv == nullptr) {
 		this->packet_recv = new Packet(this);
 	}
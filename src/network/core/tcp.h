@@ -29,10 +29,22 @@ enum SendPacketsState {
 class NetworkTCPSocketHandler : public NetworkSocketHandler {
 private:
 	Packet *packet_queue;     ///< Packets that are awaiting delivery
+	Packet *packet_queue_last; ///< Last packet in #packet_queue, so packets can be appended without walking the queue.
 	Packet *packet_recv;      ///< Partially received packet
+protected:
+	size_t raw_data_remaining; ///< Amount of raw data directly following the last received packet that still has to be received.
+
+	/**
+	 * Handle raw data that directly follows a packet; see #raw_data_remaining.
+	 * @param data The received data.
+	 * @param len  The amount of received data.
+	 */
+	virtual void ReceiveRawData(const byte *data, size_t len) {}
+
 public:
 	SOCKET sock;              ///< The socket currently connected to
 	bool writable;            ///< Can we write to this socket?
+	uint32 poll_events;       ///< Events this socket is registered for with the listener's epoll instance, 0 when not registered.
 
 	/**
 	 * Whether this socket is currently bound to a socket.
@@ -46,6 +58,12 @@ public:
 
 	virtual Packet *ReceivePacket();
 
+	/**
+	 * Whether packets are accepted from this socket at the moment.
+	 * @return false when receiving is throttled, so readiness to read should not be waited for.
+	 */
+	virtual bool CanReceivePacket() const { return true; }
+
 	bool CanSendReceive();
 
 	/**
@@ -61,6 +61,7 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_GAMESCRIPT,      ///< The server gives the admin information from the GameScript in JSON.
 	ADMIN_PACKET_SERVER_RCON_END,        ///< The server indicates that the remote console command has completed.
 	ADMIN_PACKET_SERVER_PONG,            ///< The server replies to a ping request from the admin.
+	ADMIN_PACKET_SERVER_STATISTICS,      ///< The server gives the admin a part of a snapshot of the statistics of the game.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -84,6 +85,7 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_STATISTICS,      ///< Snapshots of the statistics of companies, stations and vehicle groups.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -99,6 +101,14 @@ enum AdminUpdateFrequency {
 };
 DECLARE_ENUM_AS_BIT_SET(AdminUpdateFrequency)
 
+/** The sections of a snapshot of the statistics, in the order they are sent. */
+enum AdminStatisticsSection {
+	ADMIN_STATISTICS_STATIONS,       ///< Statistics of the stations.
+	ADMIN_STATISTICS_VEHICLE_GROUPS, ///< Statistics of the vehicles per company, group and vehicle type.
+	ADMIN_STATISTICS_COMPANIES,      ///< Statistics of the companies.
+	ADMIN_STATISTICS_END,            ///< The snapshot is complete.
+};
+
 /** Reasons for removing a company - communicated to admins. */
 enum AdminCompanyRemoveReason {
 	ADMIN_CRR_MANUAL,    ///< The company is manually removed.
@@ -479,6 +489,46 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_RCON_END(Packet *p);
 
+	/**
+	 * Send a part of a snapshot of the statistics of the game, all taken between the same two ticks:
+	 * uint32  Date of the snapshot.
+	 * uint8   Fraction of the day of the snapshot.
+	 * uint8   Section of the records in this packet, see #AdminStatisticsSection.
+	 *         The last packet of a snapshot has section #ADMIN_STATISTICS_END and no records.
+	 * uint16  Number of records in this packet.
+	 * Per record of #ADMIN_STATISTICS_STATIONS:
+	 *   uint16  ID of the station.
+	 *   uint8   ID of the owner.
+	 *   uint8   Facilities of the station (see #StationFacility).
+	 *   uint8   Number of cargo types that follow; only those with a rating at the station.
+	 *   Per cargo type:
+	 *     uint8   The cargo type.
+	 *     uint8   Rating of the cargo type.
+	 *     uint32  Amount of cargo waiting.
+	 * Per record of #ADMIN_STATISTICS_VEHICLE_GROUPS:
+	 *   uint8   ID of the company.
+	 *   uint16  ID of the group, or DEFAULT_GROUP for the vehicles that are not in a group.
+	 *   uint8   Type of the vehicles (see #VehicleType).
+	 *   uint16  Number of vehicles.
+	 *   uint64  Profit of the vehicles this year.
+	 *   uint64  Profit of the vehicles last year.
+	 *   uint16  Number of vehicles that made a loss last year, only counting those old enough to make a profit.
+	 *   uint16  Average reliability of the vehicles.
+	 * Per record of #ADMIN_STATISTICS_COMPANIES:
+	 *   uint8   ID of the company.
+	 *   uint64  Money.
+	 *   uint64  Loan.
+	 *   uint64  Net profit this year; the income minus all expenses.
+	 *   uint64  Value of the company at the end of the last quarter.
+	 *   uint16  Performance of the company in the last quarter.
+	 *   uint32  Cargo delivered this quarter.
+	 *   uint32  Number of vehicles.
+	 *   uint16  Number of stations.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_STATISTICS(Packet *p);
+
 	NetworkRecvStatus HandlePacket(Packet *p);
 public:
 	NetworkRecvStatus CloseConnection(bool error = true) override;
@@ -121,6 +121,10 @@ enum PacketGameType {
 	PACKET_CLIENT_ERROR,                 ///< A client reports an error to the server.
 	PACKET_SERVER_ERROR_QUIT,            ///< A server tells that a client has hit an error and did quit.
 
+	/* Map transfer in large frames. */
+	PACKET_SERVER_MAP_BULK,              ///< Server sends a large part of the map to the client, directly following the packet.
+	PACKET_SERVER_COMMANDS,              ///< Server distributes several commands for the same frame to (all) the clients.
+
 	PACKET_END,                          ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -268,7 +272,7 @@ protected:
 
 	/**
 	 * Request the map from the server.
-	 * uint32  NewGRF version (release versions of OpenTTD only).
+	 * bool    Whether the client can receive the map in bulk frames (optional).
 	 * @param p The packet that was just received.
 	 */
 	virtual NetworkRecvStatus Receive_CLIENT_GETMAP(Packet *p);
@@ -301,6 +305,14 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_MAP_DATA(Packet *p);
 
+	/**
+	 * Announces a part of the map that directly follows this packet, without
+	 * being part of it. Only sent when the client asked for it when requesting the map.
+	 * uint32  Number of bytes of the map following the packet.
+	 * @param p The packet that was just received.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_MAP_BULK(Packet *p);
+
 	/**
 	 * Sends that all data of the map are sent to the client:
 	 * @param p The packet that was just received.
@@ -336,6 +348,8 @@ protected:
 	 * uint32  Frame counter.
 	 * uint32  General seed 1.
 	 * uint32  General seed 2 (dependent on compile settings, not default).
+	 * uint8   Region of the map that is hashed (optional).
+	 * uint32  Hashes of the parts of the game state, see #NetworkSyncHash (optional).
 	 * @param p The packet that was just received.
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_SYNC(Packet *p);
@@ -375,6 +389,23 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_COMMAND(Packet *p);
 
+	/**
+	 * Sends several DoCommands that are executed in the same frame to the client:
+	 * uint32  Frame of execution.
+	 * Followed by the commands until the end of the packet, each:
+	 * uint8   Flags telling which of the following fields are sent; the others
+	 *         are the same as those of the previous command in the packet.
+	 * uint8   ID of the company (0..MAX_COMPANIES-1), if not the same.
+	 * uint32  ID of the command (see command.h), if not the same.
+	 * uint32  P1 (free variable used in DoCommand), if not the same.
+	 * uint32  P2, if not the same.
+	 * uint32  Tile where this is taking place, if not the same.
+	 * string  Text, if there is one.
+	 * uint8   ID of the callback, if there is one.
+	 * @param p The packet that was just received.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_COMMANDS(Packet *p);
+
 	/**
 	 * Sends a chat-packet to the server:
 	 * uint8   ID of the action (see NetworkAction).
@@ -554,6 +585,8 @@ public:
 
 	const char *ReceiveCommand(Packet *p, CommandPacket *cp);
 	void SendCommand(Packet *p, const CommandPacket *cp);
+	const char *ReceiveBatchedCommand(Packet *p, CommandPacket *cp, const CommandPacket *prev);
+	bool SendBatchedCommand(Packet *p, const CommandPacket *cp, const CommandPacket *prev);
 };
 
 #endif /* NETWORK_CORE_TCP_GAME_H */
@@ -31,6 +31,80 @@ class TCPListenHandler {
 	/** List of sockets we listen on. */
 	static SocketList sockets;
 
+#if defined(HAVE_EPOLL)
+	/** Epoll instance the listeners and connected sockets are registered with, or -1 when select() has to be used. */
+	static int epoll_fd;
+
+	/** Marker in the event data for listening sockets; connected sockets store their pool index there. */
+	static const uint32 EPOLL_LISTENER = UINT32_MAX;
+
+	/**
+	 * Register a socket with the epoll instance, or change the events it is registered for.
+	 * @param s The socket.
+	 * @param index The pool index of the socket, or #EPOLL_LISTENER.
+	 * @param registered The events the socket is registered for now, 0 when it is not registered.
+	 * @param events The events to wait for.
+	 * @return True if the registration succeeded.
+	 */
+	static bool EpollRegister(SOCKET s, uint32 index, uint32 registered, uint32 events)
+	{
+		struct epoll_event ev;
+		ev.events = events;
+		ev.data.u64 = (uint64)index << 32 | (uint32)s;
+		if (epoll_ctl(epoll_fd, registered == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, s, &ev) == 0) return true;
+		DEBUG(net, 0, "[%s] epoll_ctl failed with error %d", Tsocket::GetName(), errno);
+		return false;
+	}
+
+	/**
+	 * Handle the receiving of packets, based on the events reported by epoll.
+	 * Connected sockets are only watched for writability after a send blocked and
+	 * for readability while they are not throttled, otherwise the level triggered
+	 * events would be reported over and over again.
+	 * @return true if everything went okay.
+	 */
+	static bool ReceiveEpoll()
+	{
+		Tsocket *cs;
+		FOR_ALL_ITEMS_FROM(Tsocket, idx, cs, 0) {
+			if (!cs->IsConnected()) continue;
+			/* Errors are always reported; including it keeps the registered events non-zero. */
+			uint32 events = EPOLLERR;
+			if (cs->CanReceivePacket()) events |= EPOLLIN;
+			if (!cs->writable) events |= EPOLLOUT;
+			if (events == cs->poll_events) continue;
+			if (EpollRegister(cs->sock, (uint32)idx, cs->poll_events, events)) cs->poll_events = events;
+		}
+
+		struct epoll_event events[64];
+		int count;
+		do {
+			count = epoll_wait(epoll_fd, events, lengthof(events), 0);
+			if (count < 0) return errno == EINTR ? _networking : false;
+
+			/* accept clients.. */
+			for (int i = 0; i < count; i++) {
+				if ((uint32)(events[i].data.u64 >> 32) == EPOLL_LISTENER) AcceptClient((SOCKET)(uint32)events[i].data.u64);
+			}
+
+			/* read stuff from clients */
+			for (int i = 0; i < count; i++) {
+				uint32 index = (uint32)(events[i].data.u64 >> 32);
+				if (index == EPOLL_LISTENER) continue;
+
+				/* The socket might have been closed by handling an earlier event. */
+				cs = Tsocket::GetIfValid(index);
+				if (cs == nullptr || cs->sock != (SOCKET)(uint32)events[i].data.u64) continue;
+
+				if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) cs->writable = true;
+				if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) cs->ReceivePackets();
+			}
+		} while (count == lengthof(events));
+
+		return _networking;
+	}
+#endif /* HAVE_EPOLL */
+
 public:
 	/**
 	 * Accepts clients from the sockets.
@@ -97,6 +171,10 @@ public:
 	 */
 	static bool Receive()
 	{
+#if defined(HAVE_EPOLL)
+		if (epoll_fd >= 0) return ReceiveEpoll();
+#endif
+
 		fd_set read_fd, write_fd;
 		struct timeval tv;
 
@@ -155,9 +233,43 @@ public:
 			return false;
 		}
 
+#if defined(HAVE_EPOLL)
+		/* The instance outlives the listeners, as connected sockets may survive a restart of the listeners. */
+		if (epoll_fd < 0) {
+			epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+			if (epoll_fd < 0) DEBUG(net, 0, "[%s] epoll_create1 failed with error %d, falling back to select", Tsocket::GetName(), errno);
+		}
+		if (epoll_fd >= 0) {
+			for (auto &s : sockets) {
+				if (!EpollRegister(s.second, EPOLL_LISTENER, 0, EPOLLIN | EPOLLERR)) {
+					/* Without the listener we would never accept anybody; use select() instead. */
+					close(epoll_fd);
+					epoll_fd = -1;
+					break;
+				}
+			}
+			if (epoll_fd < 0) {
+				Tsocket *cs;
+				FOR_ALL_ITEMS_FROM(Tsocket, idx, cs, 0) cs->poll_events = 0;
+			}
+		}
+#endif
+
 		return true;
 	}
 
+	/**
+	 * Get the handle that becomes readable when any of our sockets has an event pending.
+	 * @return The handle, or INVALID_SOCKET when readiness can't be waited for.
+	 */
+	static SOCKET GetEventHandle()
+	{
+#if defined(HAVE_EPOLL)
+		if (epoll_fd >= 0 && sockets.size() != 0) return epoll_fd;
+#endif
+		return INVALID_SOCKET;
+	}
+
 	/** Close the sockets we're listening on. */
 	static void CloseListeners()
 	{
@@ -170,5 +282,8 @@ public:
 };
 
 template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> SocketList TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::sockets;
+#if defined(HAVE_EPOLL)
+template <class Tsocket, PacketType Tfull_packet, PacketType Tban_packet> int TCPListenHandler<Tsocket, Tfull_packet, Tban_packet>::epoll_fd = -1;
+#endif
 
 #endif /* NETWORK_CORE_TCP_LISTEN_H */
@@ -30,11 +30,14 @@
 #include "../window_func.h"
 #include "../company_func.h"
 #include "../company_base.h"
+#include "../vehicle_base.h"
+#include "../station_base.h"
 #include "../landscape_type.h"
 #include "../rev.h"
 #include "../core/pool_func.hpp"
 #include "../gfx_func.h"
 #include "../error.h"
+#include "../thread.h"
 
 #include "../safeguards.h"
 
@@ -56,6 +59,8 @@ bool _network_server;     ///< network-server is active
 bool _network_available;  ///< is network mode available?
 bool _network_dedicated;  ///< are we a dedicated server?
 bool _is_network_server;  ///< Does this client wants to be a network-server?
+bool _network_relay;      ///< are we relaying the game of a server to spectators?
+bool _is_network_relay;   ///< Does this client wants to relay the game it joins to spectators?
 NetworkServerGameInfo _network_game_info; ///< Information about our game.
 NetworkCompanyState *_network_company_states = nullptr; ///< Statistics about some companies.
 ClientID _network_own_client_id;      ///< Our client identifier.
@@ -76,6 +81,9 @@ uint32 _sync_seed_2;                  ///< Second part of the seed.
 #endif
 uint32 _sync_frame;                   ///< The frame to perform the sync check.
 bool _network_first_time;             ///< Whether we have finished joining or not.
+uint8 _sync_hash_region;              ///< The map region that is hashed at the (next) sync check.
+uint32 _sync_hashes[NSH_END];         ///< The hashes of the server's game state to compare during sync checks.
+bool _sync_hashes_valid;              ///< Whether the server sent hashes for the next sync check.
 bool _network_udp_server;             ///< Is the UDP server started?
 uint16 _network_udp_broadcast;        ///< Timeout for the UDP broadcasts.
 uint8 _network_advertise_retries;     ///< The number of advertisement retries we did.
@@ -278,6 +286,105 @@ void NetworkTextMessage(NetworkAction action, TextColour colour, bool self_send,
 	NetworkAddChatMessage((TextColour)colour, _settings_client.gui.network_chat_timeout, "%s", message);
 }
 
+/**
+ * Add a value to a sync hash.
+ * @param hash The hash to add to.
+ * @param value The value to add.
+ */
+static inline void AddToSyncHash(uint32 &hash, uint32 value)
+{
+	hash = (ROL(hash, 13) ^ value) * 0x9E3779B1;
+}
+
+/**
+ * Add a 64 bits value to a sync hash.
+ * @param hash The hash to add to.
+ * @param value The value to add.
+ */
+static inline void AddToSyncHash(uint32 &hash, int64 value)
+{
+	AddToSyncHash(hash, (uint32)GB(value, 0, 32));
+	AddToSyncHash(hash, (uint32)GB(value, 32, 32));
+}
+
+/**
+ * Hash the parts of the game state that should be the same for the server and all
+ * clients. Only one region of the map is hashed each time to keep this cheap.
+ * The values are hashed field by field, so the hash does not depend on endianness.
+ * @param region The map region to hash.
+ * @param[out] hashes The hashes of the parts of the game state.
+ */
+void NetworkCalculateSyncHashes(uint region, uint32 hashes[NSH_END])
+{
+	for (uint i = 0; i < NSH_END; i++) hashes[i] = 0;
+
+	uint region_size = MapSize() / NETWORK_SYNC_HASH_MAP_REGIONS;
+	for (TileIndex t = region * region_size; t < (region + 1) * region_size; t++) {
+		const Tile &m = _m[t];
+		const TileExtended &me = _me[t];
+		AddToSyncHash(hashes[NSH_MAP], m.type | m.height << 8 | (uint32)m.m2 << 16);
+		AddToSyncHash(hashes[NSH_MAP], m.m1 | m.m3 << 8 | m.m4 << 16 | (uint32)m.m5 << 24);
+		AddToSyncHash(hashes[NSH_MAP], me.m6 | me.m7 << 8 | (uint32)me.m8 << 16);
+	}
+
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		AddToSyncHash(hashes[NSH_COMPANIES], (uint32)c->index);
+		AddToSyncHash(hashes[NSH_COMPANIES], (int64)c->money);
+		AddToSyncHash(hashes[NSH_COMPANIES], (int64)c->current_loan);
+	}
+
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		/* Effect vehicles do not influence the rest of the game. */
+		if (v->type == VEH_EFFECT) continue;
+
+		AddToSyncHash(hashes[NSH_VEHICLES], (uint32)v->index);
+		AddToSyncHash(hashes[NSH_VEHICLES], (uint32)v->tile);
+		AddToSyncHash(hashes[NSH_VEHICLES], (uint32)v->x_pos ^ (uint32)v->y_pos << 16);
+		AddToSyncHash(hashes[NSH_VEHICLES], v->z_pos | v->direction << 8 | (uint32)v->vehstatus << 16);
+		AddToSyncHash(hashes[NSH_VEHICLES], v->cur_speed | (uint32)v->progress << 16);
+		AddToSyncHash(hashes[NSH_VEHICLES], (uint32)v->cargo.TotalCount());
+		AddToSyncHash(hashes[NSH_VEHICLES], (int64)v->profit_this_year);
+	}
+
+	const Station *st;
+	FOR_ALL_STATIONS(st) {
+		AddToSyncHash(hashes[NSH_STATIONS], (uint32)st->index);
+		for (CargoID cid = 0; cid < NUM_CARGO; cid++) {
+			const GoodsEntry &ge = st->goods[cid];
+			AddToSyncHash(hashes[NSH_STATIONS], (uint32)ge.cargo.TotalCount());
+			AddToSyncHash(hashes[NSH_STATIONS], (uint32)(ge.rating | ge.status << 8));
+		}
+	}
+}
+
+/**
+ * Compare our game state with the hashes of the server's game state, if it sent them.
+ * @param buf Buffer for the names of the parts of the game state that diverged.
+ * @param last The last element of the buffer.
+ * @return Whether the game states are the same.
+ */
+bool NetworkCheckSyncHashes(char *buf, const char *last)
+{
+	static const char * const names[] = { "map", "companies", "vehicles", "stations" };
+	assert_compile(lengthof(names) == NSH_END);
+
+	*buf = '\0';
+	if (!_sync_hashes_valid) return true;
+
+	uint32 hashes[NSH_END];
+	NetworkCalculateSyncHashes(_sync_hash_region, hashes);
+
+	bool in_sync = true;
+	for (uint i = 0; i < NSH_END; i++) {
+		if (hashes[i] == _sync_hashes[i]) continue;
+		buf += seprintf(buf, last, in_sync ? "%s" : ", %s", names[i]);
+		in_sync = false;
+	}
+	return in_sync;
+}
+
 /* Calculate the frame-lag of a client */
 uint NetworkCalculateLag(const NetworkClientSocket *cs)
 {
@@ -527,7 +634,7 @@ static void InitializeNetworkPools(bool close_admins = true)
  */
 void NetworkClose(bool close_admins)
 {
-	if (_network_server) {
+	if (_network_server || _network_relay) {
 		if (close_admins) {
 			ServerNetworkAdminSocketHandler *as;
 			FOR_ALL_ADMIN_SOCKETS(as) {
@@ -541,7 +648,8 @@ void NetworkClose(bool close_admins)
 		}
 		ServerNetworkGameSocketHandler::CloseListeners();
 		ServerNetworkAdminSocketHandler::CloseListeners();
-	} else if (MyClient::my_client != nullptr) {
+	}
+	if (!_network_server && MyClient::my_client != nullptr) {
 		MyClient::SendQuit();
 		MyClient::my_client->CloseConnection(NETWORK_RECV_STATUS_CONN_LOST);
 	}
@@ -550,6 +658,7 @@ void NetworkClose(bool close_admins)
 
 	_networking = false;
 	_network_server = false;
+	_network_relay = false;
 
 	NetworkFreeLocalCommandQueue();
 
@@ -566,6 +675,7 @@ static void NetworkInitialize(bool close_admins = true)
 	NetworkUDPInitialize();
 
 	_sync_frame = 0;
+	_sync_hashes_valid = false;
 	_network_first_time = true;
 
 	_network_reconnect = 0;
@@ -795,7 +905,7 @@ void NetworkReboot()
  */
 void NetworkDisconnect(bool blocking, bool close_admins)
 {
-	if (_network_server) {
+	if (_network_server || _network_relay) {
 		NetworkClientSocket *cs;
 		FOR_ALL_CLIENT_SOCKETS(cs) {
 			cs->SendShutdown();
@@ -831,6 +941,7 @@ static bool NetworkReceive()
 		ServerNetworkAdminSocketHandler::Receive();
 		return ServerNetworkGameSocketHandler::Receive();
 	} else {
+		if (_network_relay) ServerNetworkGameSocketHandler::Receive();
 		return ClientNetworkGameSocketHandler::Receive();
 	}
 }
@@ -843,7 +954,41 @@ static void NetworkSend()
 		ServerNetworkGameSocketHandler::Send();
 	} else {
 		ClientNetworkGameSocketHandler::Send();
+		if (_network_relay) ServerNetworkGameSocketHandler::Send();
+	}
+}
+
+/**
+ * Wait until one of the server's sockets has something to do, or until the timeout expires.
+ * Traffic that arrives while waiting is handled right away, instead of at the next tick.
+ * A relay also waits for its spectators and for the server it relays.
+ * When readiness can't be waited for this simply sleeps.
+ * @param timeout The maximum time to wait in milliseconds.
+ */
+void NetworkServerWaitForEvents(uint timeout)
+{
+#if defined(HAVE_EPOLL)
+	/* Without a handle for the game sockets they are polled with select(), so just sleep. */
+	SOCKET game = (_networking && (_network_server || _network_relay)) ? ServerNetworkGameSocketHandler::GetEventHandle() : INVALID_SOCKET;
+	if (game != INVALID_SOCKET) {
+		/* The admin port is only opened by a server, the connection with a server only exists for a relay. */
+		SOCKET other = _network_server ? ServerNetworkAdminSocketHandler::GetEventHandle() : ClientNetworkGameSocketHandler::GetEventHandle();
+
+		struct pollfd fds[2];
+		nfds_t count = 0;
+		for (SOCKET s : { game, other }) {
+			if (s == INVALID_SOCKET) continue;
+			fds[count].fd = s;
+			fds[count].events = POLLIN;
+			fds[count].revents = 0;
+			count++;
+		}
+
+		if (poll(fds, count, timeout) > 0 && NetworkReceive()) NetworkSend();
+		return;
 	}
+#endif
+	CSleep(timeout);
 }
 
 /**
@@ -1003,16 +1148,17 @@ void NetworkGameLoop()
 		_sync_seed_2 = _random.state[1];
 #endif
 
+		/* Between two ticks the game is consistent, so take the statistics for the admins now. */
+		NetworkAdminStatisticsTick();
+
 		NetworkServer_Tick(send_frame);
 	} else {
 		/* Client */
 
 		/* Make sure we are at the frame were the server is (quick-frames) */
 		if (_frame_counter_server > _frame_counter) {
-			/* Run a number of frames; when things go bad, get out. */
-			while (_frame_counter_server > _frame_counter) {
-				if (!ClientNetworkGameSocketHandler::GameLoop()) return;
-			}
+			/* Run the frames we are behind; when things go bad, get out. */
+			if (!ClientNetworkGameSocketHandler::CatchUp()) return;
 		} else {
 			/* Else, keep on going till _frame_counter_max */
 			if (_frame_counter_max > _frame_counter) {
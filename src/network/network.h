@@ -16,11 +16,15 @@ void NetworkStartUp();
 void NetworkShutDown();
 void NetworkDrawChatMessage();
 bool HasClients();
+void NetworkServerWaitForEvents(uint timeout);
 
 extern bool _networking;         ///< are we in networking mode?
 extern bool _network_server;     ///< network-server is active
 extern bool _network_available;  ///< is network mode available?
 extern bool _network_dedicated;  ///< are we a dedicated server?
 extern bool _is_network_server;  ///< Does this client wants to be a network-server?
+extern bool _network_relay;      ///< are we relaying the game of a server to spectators?
+extern bool _is_network_relay;   ///< Does this client wants to relay the game it joins to spectators?
+extern bool _network_catching_up; ///< Is the client running the frames it is behind back-to-back?
 
 #endif /* NETWORK_H */
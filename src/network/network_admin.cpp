@@ -22,6 +22,13 @@
 #include "../map_func.h"
 #include "../rev.h"
 #include "../game/game.hpp"
+#include "../station_base.h"
+#include "../vehicle_base.h"
+#include "../vehicle_func.h"
+#include "../thread.h"
+
+#include <algorithm>
+#include <atomic>
 
 #include "../safeguards.h"
 
@@ -54,6 +61,7 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_STATISTICS
 };
 /** Sanity check. */
 assert_compile(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -67,6 +75,7 @@ ServerNetworkAdminSocketHandler::ServerNetworkAdminSocketHandler(SOCKET s) : Net
 	_network_admins_connected++;
 	this->status = ADMIN_STATUS_INACTIVE;
 	this->realtime_connect = _realtime_tick;
+	this->statistics_requested = false;
 }
 
 /**
@@ -77,6 +86,7 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
 	_network_admins_connected--;
 	DEBUG(net, 1, "[admin] '%s' (%s) has disconnected", this->admin_name, this->admin_version);
 	if (_redirect_console_to_admin == this->index) _redirect_console_to_admin = INVALID_ADMIN_ID;
+	NetworkAdminForgetStatistics(this->index);
 }
 
 /**
@@ -96,6 +106,8 @@ ServerNetworkAdminSocketHandler::~ServerNetworkAdminSocketHandler()
 /** Send the packets for the server sockets. */
 /* static */ void ServerNetworkAdminSocketHandler::Send()
 {
+	NetworkAdminSendStatistics();
+
 	ServerNetworkAdminSocketHandler *as;
 	FOR_ALL_ADMIN_SOCKETS(as) {
 		if (as->status == ADMIN_STATUS_INACTIVE && as->realtime_connect + ADMIN_AUTHORISATION_TIMEOUT < _realtime_tick) {
@@ -776,6 +788,11 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_STATISTICS:
+			/* The admin is requesting a snapshot of the statistics; it is taken at the end of this tick. */
+			this->statistics_requested = true;
+			break;
+
 		default:
 			/* An unsupported "poll" update type. */
 			DEBUG(net, 3, "[admin] Not supported poll %d (%d) from '%s' (%s).", type, d1, this->admin_name, this->admin_version);
@@ -1037,9 +1054,323 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_STATISTICS:
+						as->statistics_requested = true;
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
 		}
 	}
 }
+
+/** A company, as it was when the statistics were taken. */
+struct AdminStatisticsCompany {
+	CompanyID index;        ///< The company.
+	int64 money;            ///< Its money.
+	int64 loan;             ///< Its loan.
+	int64 profit;           ///< Its net profit this year, i.e. its income minus all its expenses.
+	int64 value;            ///< Its value at the end of the last quarter.
+	uint16 performance;     ///< Its performance in the last quarter.
+	uint32 delivered_cargo; ///< The cargo it delivered this quarter.
+	uint32 num_vehicles;    ///< Its number of primary vehicles; filled in when encoding.
+	uint16 num_stations;    ///< Its number of stations; filled in when encoding.
+};
+
+/** A station, as it was when the statistics were taken. */
+struct AdminStatisticsStation {
+	StationID index;  ///< The station.
+	Owner owner;      ///< Its owner.
+	byte facilities;  ///< Its facilities.
+	uint8 num_cargo;  ///< The number of its cargo types in #AdminStatisticsSnapshot::cargo.
+};
+
+/** A cargo type at a station, as it was when the statistics were taken. */
+struct AdminStatisticsCargo {
+	CargoID cargo;  ///< The cargo type.
+	byte rating;    ///< Its rating.
+	uint32 waiting; ///< The amount waiting.
+};
+
+/** A primary vehicle, as it was when the statistics were taken. */
+struct AdminStatisticsVehicle {
+	CompanyID owner;        ///< Its owner.
+	GroupID group;          ///< Its group.
+	VehicleType type;       ///< Its type.
+	bool loss;              ///< Whether it is old enough to make a profit, yet made a loss last year.
+	uint16 reliability;     ///< Its reliability.
+	int64 profit_this_year; ///< Its profit this year.
+	int64 profit_last_year; ///< Its profit last year.
+
+	/** Order the vehicles by company, group and type, so the vehicles of a group are next to each other. */
+	bool operator <(const AdminStatisticsVehicle &other) const
+	{
+		if (this->owner != other.owner) return this->owner < other.owner;
+		if (this->group != other.group) return this->group < other.group;
+		return this->type < other.type;
+	}
+};
+
+/**
+ * A snapshot of the statistics for the admins. The data is copied from the
+ * game between two ticks, so it is consistent. The aggregation and encoding
+ * into packets happen in a thread, so the game does not have to wait for it.
+ */
+struct AdminStatisticsSnapshot {
+	Date date;                                     ///< The date of the snapshot.
+	DateFract date_fract;                          ///< The fraction of the day of the snapshot.
+	uint32 admins;                                 ///< Bitmask of the admins that get the snapshot.
+	std::vector<AdminStatisticsCompany> companies; ///< The companies.
+	std::vector<AdminStatisticsStation> stations;  ///< The stations.
+	std::vector<AdminStatisticsCargo> cargo;       ///< The cargo types of all stations, in the order of the stations.
+	std::vector<AdminStatisticsVehicle> vehicles;  ///< The primary vehicles.
+
+	std::vector<Packet *> packets;                 ///< The encoded snapshot.
+	std::thread thread;                            ///< The thread encoding the snapshot.
+	std::atomic<bool> done;                        ///< Whether the snapshot has been encoded.
+
+	Packet *packet;                                ///< The packet that is being written.
+	AdminStatisticsSection section;                ///< The section that is being written.
+	uint16 count;                                  ///< The number of records in the packet that is being written.
+
+	AdminStatisticsSnapshot() : admins(0), done(false), packet(nullptr) {}
+	void Capture();
+	void Encode();
+	Packet *StartRecord(AdminStatisticsSection section, uint size);
+	void FinishPacket();
+};
+
+assert_compile(MAX_ADMINS <= 32);
+
+/** The snapshot that is being encoded or waiting to be sent, if any. */
+static AdminStatisticsSnapshot *_admin_statistics = nullptr;
+
+/** The size of the header of every statistics packet. */
+static const uint ADMIN_STATISTICS_HEADER_SIZE = sizeof(PacketSize) + sizeof(PacketType) + sizeof(uint32) + sizeof(uint8) + sizeof(uint8) + sizeof(uint16);
+
+/** Copy everything the snapshot needs from the game. */
+void AdminStatisticsSnapshot::Capture()
+{
+	this->date = _date;
+	this->date_fract = _date_fract;
+
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		AdminStatisticsCompany data;
+		data.index = c->index;
+		data.money = c->money;
+		data.loan = c->current_loan;
+		data.profit = 0;
+		for (uint i = 0; i < lengthof(c->yearly_expenses[0]); i++) {
+			data.profit -= c->yearly_expenses[0][i];
+		}
+		data.value = c->old_economy[0].company_value;
+		data.performance = c->old_economy[0].performance_history;
+		data.delivered_cargo = min<int64>(UINT32_MAX, c->cur_economy.delivered_cargo.GetSum<OverflowSafeInt64>());
+		this->companies.push_back(data);
+	}
+
+	const Station *st;
+	FOR_ALL_STATIONS(st) {
+		AdminStatisticsStation data;
+		data.index = st->index;
+		data.owner = st->owner;
+		data.facilities = st->facilities;
+		data.num_cargo = 0;
+		for (CargoID cid = 0; cid < NUM_CARGO; cid++) {
+			const GoodsEntry &ge = st->goods[cid];
+			if (!ge.HasRating()) continue;
+
+			AdminStatisticsCargo cargo;
+			cargo.cargo = cid;
+			cargo.rating = ge.rating;
+			cargo.waiting = ge.cargo.TotalCount();
+			this->cargo.push_back(cargo);
+			data.num_cargo++;
+		}
+		this->stations.push_back(data);
+	}
+
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (!v->IsPrimaryVehicle()) continue;
+
+		AdminStatisticsVehicle data;
+		data.owner = v->owner;
+		data.group = v->group_id;
+		data.type = v->type;
+		data.loss = v->age > VEHICLE_PROFIT_MIN_AGE && v->profit_last_year < 0;
+		data.reliability = v->reliability;
+		data.profit_this_year = v->GetDisplayProfitThisYear();
+		data.profit_last_year = v->GetDisplayProfitLastYear();
+		this->vehicles.push_back(data);
+	}
+}
+
+/**
+ * Get the packet to write the next record into, starting a new packet when the record does not fit anymore.
+ * @param section The section of the record.
+ * @param size The size of the record.
+ * @return The packet to write the record into.
+ */
+Packet *AdminStatisticsSnapshot::StartRecord(AdminStatisticsSection section, uint size)
+{
+	assert(ADMIN_STATISTICS_HEADER_SIZE + size <= SEND_MTU);
+
+	if (this->packet != nullptr && (this->section != section || this->count == UINT16_MAX || this->packet->size + size > SEND_MTU)) {
+		this->FinishPacket();
+	}
+
+	if (this->packet == nullptr) {
+		this->packet = new Packet(ADMIN_PACKET_SERVER_STATISTICS);
+		this->packet->Send_uint32(this->date);
+		this->packet->Send_uint8(this->date_fract);
+		this->packet->Send_uint8(section);
+		this->packet->Send_uint16(0); // Number of records, filled in by FinishPacket.
+		this->section = section;
+		this->count = 0;
+	}
+
+	this->count++;
+	return this->packet;
+}
+
+/** Fill in the number of records of the packet that is being written, and add it to the encoded snapshot. */
+void AdminStatisticsSnapshot::FinishPacket()
+{
+	PacketSize pos = ADMIN_STATISTICS_HEADER_SIZE - sizeof(uint16);
+	this->packet->buffer[pos]     = GB(this->count, 0, 8);
+	this->packet->buffer[pos + 1] = GB(this->count, 8, 8);
+
+	this->packets.push_back(this->packet);
+	this->packet = nullptr;
+}
+
+/** Aggregate the copied data and encode it into packets. */
+void AdminStatisticsSnapshot::Encode()
+{
+	uint32 num_vehicles[MAX_COMPANIES] = {};
+	uint16 num_stations[MAX_COMPANIES] = {};
+
+	const AdminStatisticsCargo *cargo = this->cargo.data();
+	for (const AdminStatisticsStation &st : this->stations) {
+		if (st.owner < MAX_COMPANIES) num_stations[st.owner]++;
+
+		Packet *p = this->StartRecord(ADMIN_STATISTICS_STATIONS, 5 + st.num_cargo * 6);
+		p->Send_uint16(st.index);
+		p->Send_uint8 (st.owner);
+		p->Send_uint8 (st.facilities);
+		p->Send_uint8 (st.num_cargo);
+		for (uint i = 0; i < st.num_cargo; i++, cargo++) {
+			p->Send_uint8 (cargo->cargo);
+			p->Send_uint8 (cargo->rating);
+			p->Send_uint32(cargo->waiting);
+		}
+	}
+
+	std::sort(this->vehicles.begin(), this->vehicles.end());
+	for (auto it = this->vehicles.begin(); it != this->vehicles.end();) {
+		const AdminStatisticsVehicle &first = *it;
+		uint count = 0;
+		uint losses = 0;
+		uint reliability = 0;
+		int64 profit_this_year = 0;
+		int64 profit_last_year = 0;
+		for (; it != this->vehicles.end() && !(first < *it); ++it) {
+			count++;
+			if (it->loss) losses++;
+			reliability += it->reliability;
+			profit_this_year += it->profit_this_year;
+			profit_last_year += it->profit_last_year;
+		}
+		if (first.owner < MAX_COMPANIES) num_vehicles[first.owner] += count;
+
+		Packet *p = this->StartRecord(ADMIN_STATISTICS_VEHICLE_GROUPS, 26);
+		p->Send_uint8 (first.owner);
+		p->Send_uint16(first.group);
+		p->Send_uint8 (first.type);
+		p->Send_uint16(min(count, UINT16_MAX));
+		p->Send_uint64(profit_this_year);
+		p->Send_uint64(profit_last_year);
+		p->Send_uint16(min(losses, UINT16_MAX));
+		p->Send_uint16(reliability / count);
+	}
+
+	for (const AdminStatisticsCompany &c : this->companies) {
+		Packet *p = this->StartRecord(ADMIN_STATISTICS_COMPANIES, 45);
+		p->Send_uint8 (c.index);
+		p->Send_uint64(c.money);
+		p->Send_uint64(c.loan);
+		p->Send_uint64(c.profit);
+		p->Send_uint64(c.value);
+		p->Send_uint16(c.performance);
+		p->Send_uint32(c.delivered_cargo);
+		p->Send_uint32(num_vehicles[c.index]);
+		p->Send_uint16(num_stations[c.index]);
+	}
+
+	/* Mark the end of the snapshot with a packet without records. */
+	this->StartRecord(ADMIN_STATISTICS_END, 0);
+	this->count = 0;
+	this->FinishPacket();
+}
+
+/**
+ * Take a snapshot of the statistics for the admins that asked for one.
+ * This is called between two ticks, so the snapshot is consistent.
+ */
+void NetworkAdminStatisticsTick()
+{
+	/* Snapshots are taken one at a time; the requests wait for the previous snapshot to be sent. */
+	if (_admin_statistics != nullptr) return;
+
+	uint32 admins = 0;
+	ServerNetworkAdminSocketHandler *as;
+	FOR_ALL_ACTIVE_ADMIN_SOCKETS(as) {
+		if (!as->statistics_requested) continue;
+		SetBit(admins, as->index);
+		as->statistics_requested = false;
+	}
+	if (admins == 0) return;
+
+	AdminStatisticsSnapshot *snapshot = new AdminStatisticsSnapshot();
+	snapshot->admins = admins;
+	snapshot->Capture();
+	_admin_statistics = snapshot;
+
+	if (!StartNewThread(&snapshot->thread, "ottd:admin-stats", [snapshot]() { snapshot->Encode(); snapshot->done = true; })) {
+		DEBUG(net, 1, "[admin] Cannot create a thread for the statistics; encoding them in the game loop");
+		snapshot->Encode();
+		snapshot->done = true;
+	}
+}
+
+/** Send the snapshot of the statistics to the admins it was taken for, once it has been encoded. */
+void NetworkAdminSendStatistics()
+{
+	AdminStatisticsSnapshot *snapshot = _admin_statistics;
+	if (snapshot == nullptr || !snapshot->done) return;
+
+	if (snapshot->thread.joinable()) snapshot->thread.join();
+
+	ServerNetworkAdminSocketHandler *as;
+	FOR_ALL_ACTIVE_ADMIN_SOCKETS(as) {
+		if (!HasBit(snapshot->admins, as->index)) continue;
+		/* The packets are the same for every admin, so they all share them. */
+		for (Packet *p : snapshot->packets) as->SendPacket(p->Share());
+	}
+
+	for (Packet *p : snapshot->packets) delete p;
+	delete snapshot;
+	_admin_statistics = nullptr;
+}
+
+/**
+ * Make sure an admin does not get the snapshot of the statistics that is being encoded, e.g. because it has left.
+ * @param admin_index The admin.
+ */
+void NetworkAdminForgetStatistics(AdminIndex admin_index)
+{
+	if (_admin_statistics != nullptr) ClrBit(_admin_statistics->admins, admin_index);
+}
@@ -41,6 +41,7 @@ public:
 	AdminUpdateFrequency update_frequency[ADMIN_UPDATE_END]; ///< Admin requested update intervals.
 	uint32 realtime_connect;                                 ///< Time of connection.
 	NetworkAddress address;                                  ///< Address of the admin.
+	bool statistics_requested;                               ///< Whether the admin wants a snapshot of the statistics at the end of this tick.
 
 	ServerNetworkAdminSocketHandler(SOCKET s);
 	~ServerNetworkAdminSocketHandler();
@@ -121,5 +122,8 @@ void NetworkServerSendAdminRcon(AdminIndex admin_index, TextColour colour_code,
 void NetworkAdminConsole(const char *origin, const char *string);
 void NetworkAdminGameScript(const char *json);
 void NetworkAdminCmdLogging(const NetworkClientSocket *owner, const CommandPacket *cp);
+void NetworkAdminStatisticsTick();
+void NetworkAdminSendStatistics();
+void NetworkAdminForgetStatistics(AdminIndex admin_index);
 
 #endif /* NETWORK_ADMIN_H */
@@ -28,11 +28,15 @@
 #include "network.h"
 #include "network_base.h"
 #include "network_client.h"
+#include "network_server.h"
 #include "../core/backup_type.hpp"
 #include "../thread.h"
+#include "../viewport_func.h"
 
 #include "table/strings.h"
 
+#include <chrono>
+
 #include "../safeguards.h"
 
 /* This file handles all the client-commands */
@@ -66,30 +70,33 @@ struct PacketReader : LoadFilter {
 	 * @param p The packet to add.
 	 */
 	void AddPacket(const Packet *p)
+	{
+		this->AddData(p->buffer + p->pos, p->size - p->pos);
+	}
+
+	/**
+	 * Add data to this buffer.
+	 * @param data The data to add.
+	 * @param len  The amount of data to add.
+	 */
+	void AddData(const byte *data, size_t len)
 	{
 		assert(this->read_bytes == 0);
 
-		size_t in_packet = p->size - p->pos;
-		size_t to_write  = min((size_t)(this->bufe - this->buf), in_packet);
-		const byte *pbuf = p->buffer + p->pos;
+		this->written_bytes += len;
+		while (len != 0) {
+			/* Allocate a new chunk when the current one is full. */
+			if (this->buf == this->bufe) {
+				this->blocks.push_back(this->buf = CallocT<byte>(CHUNK));
+				this->bufe = this->buf + CHUNK;
+			}
 
-		this->written_bytes += in_packet;
-		if (to_write != 0) {
-			memcpy(this->buf, pbuf, to_write);
+			size_t to_write = min((size_t)(this->bufe - this->buf), len);
+			memcpy(this->buf, data, to_write);
 			this->buf += to_write;
+			data += to_write;
+			len -= to_write;
 		}
-
-		/* Did everything fit in the current chunk, then we're done. */
-		if (to_write == in_packet) return;
-
-		/* Allocate a new chunk and add the remaining data. */
-		pbuf += to_write;
-		to_write   = in_packet - to_write;
-		this->blocks.push_back(this->buf = CallocT<byte>(CHUNK));
-		this->bufe = this->buf + CHUNK;
-
-		memcpy(this->buf, pbuf, to_write);
-		this->buf += to_write;
 	}
 
 	size_t Read(byte *rbuf, size_t size) override
@@ -155,6 +162,9 @@ ClientNetworkGameSocketHandler::~ClientNetworkGameSocketHandler()
 	assert(ClientNetworkGameSocketHandler::my_client == this);
 	ClientNetworkGameSocketHandler::my_client = nullptr;
 
+	/* Whatever we were catching up with is gone. */
+	_network_catching_up = false;
+
 	delete this->savegame;
 }
 
@@ -281,6 +291,16 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 				return false;
 			}
 
+			/* The random seeds match, but other parts of the game state might already have diverged. */
+			char diverged[64];
+			if (!NetworkCheckSyncHashes(diverged, lastof(diverged))) {
+				NetworkError(STR_NETWORK_ERROR_DESYNC);
+				DEBUG(desync, 1, "sync_err: %08x; %02x; %s", _date, _date_fract, diverged);
+				DEBUG(net, 0, "Sync error detected in: %s", diverged);
+				my_client->ClientError(NETWORK_RECV_STATUS_DESYNC);
+				return false;
+			}
+
 			/* If this is the first time we have a sync-frame, we
 			 *   need to let the server know that we are ready and at the same
 			 *   frame as he is.. so we can start playing! */
@@ -296,6 +316,99 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 		}
 	}
 
+	/* Pass the frame on to the spectators of our relay. */
+	if (_network_relay) NetworkRelay_Tick();
+
+	return true;
+}
+
+/** Is the client running the frames it is behind back-to-back? */
+bool _network_catching_up = false;
+
+/** Number of frames the client has to be behind on the server before it starts catching up. */
+static const uint32 NETWORK_CATCH_UP_MIN_FRAMES = DAY_TICKS;
+/** Maximum time in milliseconds to run frames back-to-back, before the connection is handled and the progress is drawn. */
+static const uint NETWORK_CATCH_UP_MAX_DURATION = 100;
+
+/** The frame catching up started at. */
+static uint32 _catch_up_start_frame;
+/** Whether the join status window shows the progress of catching up. */
+static bool _catch_up_progress;
+/** The join status to return to after catching up, or #NETWORK_JOIN_STATUS_END when the join status window was opened for catching up. */
+static NetworkJoinStatus _catch_up_join_status;
+
+/**
+ * Stop catching up; the game gets drawn again and the join status window
+ * goes back to what it was showing before, if it showed the progress.
+ */
+static void NetworkStopCatchingUp()
+{
+	_network_catching_up = false;
+
+	if (_catch_up_progress && _catch_up_join_status == NETWORK_JOIN_STATUS_END) {
+		DeleteWindowById(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
+	} else if (_catch_up_progress) {
+		_network_join_status = _catch_up_join_status;
+		SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
+	}
+
+	MarkWholeScreenDirty();
+	DEBUG(net, 1, "Caught up at frame %d", _frame_counter);
+}
+
+/**
+ * Run the frames we are behind on the server. When we are far behind, e.g.
+ * right after joining, we start catching up: the frames are run back-to-back
+ * without drawing the viewports, playing sounds or ticking the windows. While
+ * joining, the join status window shows the progress. Every so often we
+ * return, so the connection gets handled and the progress drawn.
+ * @return Whether everything went okay, or not.
+ */
+/* static */ bool ClientNetworkGameSocketHandler::CatchUp()
+{
+	if (!_network_catching_up) {
+		if (_frame_counter_server - _frame_counter < NETWORK_CATCH_UP_MIN_FRAMES) {
+			/* Just a few frames; run them right away. */
+			while (_frame_counter_server > _frame_counter) {
+				if (!GameLoop()) return false;
+			}
+			return true;
+		}
+
+		DEBUG(net, 1, "Catching up %d frames", _frame_counter_server - _frame_counter);
+		_network_catching_up = true;
+		_catch_up_start_frame = _frame_counter;
+		_network_join_frames = 0;
+		_network_join_frames_total = _frame_counter_server - _frame_counter;
+
+		/* Show the progress while joining. In the middle of the game the modal window would
+		 * be worse than the short stall, unless the join status window is open anyway. */
+		bool open = FindWindowById(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN) != nullptr;
+		_catch_up_progress = open || _network_first_time;
+		if (_catch_up_progress) {
+			_catch_up_join_status = open ? _network_join_status : NETWORK_JOIN_STATUS_END;
+			_network_join_status = NETWORK_JOIN_STATUS_PROCESSING;
+			if (open) {
+				SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
+			} else {
+				ShowJoinStatusWindow();
+			}
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	while (_frame_counter_server > _frame_counter) {
+		if (!GameLoop()) return false;
+		if (std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(NETWORK_CATCH_UP_MAX_DURATION)) break;
+	}
+
+	if (_frame_counter_server > _frame_counter) {
+		_network_join_frames = _frame_counter - _catch_up_start_frame;
+		_network_join_frames_total = _frame_counter_server - _catch_up_start_frame;
+		if (_catch_up_progress) SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
+	} else {
+		NetworkStopCatchingUp();
+	}
 	return true;
 }
 
@@ -399,6 +512,8 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::SendGetMap()
 	my_client->status = STATUS_MAP_WAIT;
 
 	Packet *p = new Packet(PACKET_CLIENT_GETMAP);
+	/* We can receive the map in bulk frames. */
+	p->Send_bool(true);
 	my_client->SendPacket(p);
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -536,6 +651,15 @@ bool ClientNetworkGameSocketHandler::IsConnected()
 	return my_client != nullptr && my_client->status == STATUS_ACTIVE;
 }
 
+/**
+ * Get the handle that becomes readable when the server sent us something.
+ * @return The socket of the connection with the server, or INVALID_SOCKET when there is none.
+ */
+SOCKET ClientNetworkGameSocketHandler::GetEventHandle()
+{
+	return my_client != nullptr ? my_client->sock : INVALID_SOCKET;
+}
+
 
 /***********
  * Receiving functions
@@ -636,6 +760,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CLIENT_INFO(Pac
 		strecpy(ci->client_name, name, lastof(ci->client_name));
 
 		SetWindowDirty(WC_CLIENT_LIST, 0);
+		if (_network_relay) NetworkRelayClientInfo(ci);
 
 		return NETWORK_RECV_STATUS_OKAY;
 	}
@@ -655,6 +780,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CLIENT_INFO(Pac
 	strecpy(ci->client_name, name, lastof(ci->client_name));
 
 	SetWindowDirty(WC_CLIENT_LIST, 0);
+	if (_network_relay) NetworkRelayClientInfo(ci);
 
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -840,6 +966,28 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DATA(Packet
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_BULK(Packet *p)
+{
+	if (this->status != STATUS_MAP) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+	if (this->savegame == nullptr) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+
+	/* The data itself directly follows this packet. */
+	this->raw_data_remaining = p->Recv_uint32();
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+void ClientNetworkGameSocketHandler::ReceiveRawData(const byte *data, size_t len)
+{
+	/* Only the map is sent as raw data. */
+	if (this->status != STATUS_MAP || this->savegame == nullptr) return;
+
+	this->savegame->AddData(data, len);
+
+	_network_join_bytes = (uint32)this->savegame->written_bytes;
+	SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
+}
+
 NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DONE(Packet *p)
 {
 	if (this->status != STATUS_MAP) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
@@ -894,6 +1042,11 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_DONE(Packet
 		SetLocalCompany(_network_join_as);
 	}
 
+	/* Now we have the game of the server, a relay can let its spectators in. */
+	if (_is_network_relay && !_network_relay && !NetworkRelayStart()) {
+		NetworkError(STR_NETWORK_ERROR_SERVER_START);
+	}
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -908,6 +1061,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_FRAME(Packet *p
 	 *  and if we are at the frame the server is */
 	if (p->pos + 1 < p->size) {
 		_sync_frame = _frame_counter_server;
+		_sync_hashes_valid = false;
 		_sync_seed_1 = p->Recv_uint32();
 #ifdef NETWORK_SEND_DOUBLE_SEED
 		_sync_seed_2 = p->Recv_uint32();
@@ -940,6 +1094,12 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_SYNC(Packet *p)
 	_sync_seed_2 = p->Recv_uint32();
 #endif
 
+	_sync_hashes_valid = p->pos < p->size;
+	if (_sync_hashes_valid) {
+		_sync_hash_region = p->Recv_uint8() % NETWORK_SYNC_HASH_MAP_REGIONS;
+		for (uint i = 0; i < NSH_END; i++) _sync_hashes[i] = p->Recv_uint32();
+	}
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -958,10 +1118,37 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMAND(Packet
 	}
 
 	this->incoming_queue.Append(&cp);
+	if (_network_relay) NetworkRelayCommand(cp);
 
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMANDS(Packet *p)
+{
+	if (this->status != STATUS_ACTIVE) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+
+	uint32 frame = p->Recv_uint32();
+
+	CommandPacket cp[2];
+	const CommandPacket *prev = nullptr;
+	for (uint i = 0; p->pos < p->size && !this->HasClientQuit(); i++) {
+		CommandPacket &c = cp[i % 2];
+		const char *err = this->ReceiveBatchedCommand(p, &c, prev);
+		c.frame = frame;
+
+		if (err != nullptr) {
+			IConsolePrintF(CC_ERROR, "WARNING: %s from server, dropping...", err);
+			return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+		}
+
+		this->incoming_queue.Append(&c);
+		if (_network_relay) NetworkRelayCommand(c);
+		prev = &c;
+	}
+
+	return this->HasClientQuit() ? NETWORK_RECV_STATUS_MALFORMED_PACKET : NETWORK_RECV_STATUS_OKAY;
+}
+
 NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CHAT(Packet *p)
 {
 	if (this->status != STATUS_ACTIVE) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
@@ -1020,14 +1207,16 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_ERROR_QUIT(Pack
 	if (this->status < STATUS_AUTHORIZED) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
 
 	ClientID client_id = (ClientID)p->Recv_uint32();
+	NetworkErrorCode errorno = (NetworkErrorCode)p->Recv_uint8();
 
 	NetworkClientInfo *ci = NetworkClientInfo::GetByClientID(client_id);
 	if (ci != nullptr) {
-		NetworkTextMessage(NETWORK_ACTION_LEAVE, CC_DEFAULT, false, ci->client_name, nullptr, GetNetworkErrorMsg((NetworkErrorCode)p->Recv_uint8()));
+		NetworkTextMessage(NETWORK_ACTION_LEAVE, CC_DEFAULT, false, ci->client_name, nullptr, GetNetworkErrorMsg(errorno));
 		delete ci;
 	}
 
 	SetWindowDirty(WC_CLIENT_LIST, 0);
+	if (_network_relay) NetworkRelayClientQuit(client_id, errorno);
 
 	return NETWORK_RECV_STATUS_OKAY;
 }
@@ -1047,6 +1236,7 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_QUIT(Packet *p)
 	}
 
 	SetWindowDirty(WC_CLIENT_LIST, 0);
+	if (_network_relay) NetworkRelayClientQuit(client_id, NETWORK_ERROR_END);
 
 	/* If we come here it means we could not locate the client.. strange :s */
 	return NETWORK_RECV_STATUS_OKAY;
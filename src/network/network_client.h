@@ -39,6 +39,7 @@ private:
 
 protected:
 	friend void NetworkExecuteLocalCommandQueue();
+	friend void NetworkSyncCommandQueue(CommandQueue *queue);
 	friend void NetworkClose(bool close_admins);
 	static ClientNetworkGameSocketHandler *my_client; ///< This is us!
 
@@ -54,11 +55,13 @@ protected:
 	NetworkRecvStatus Receive_SERVER_MAP_BEGIN(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_MAP_SIZE(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_MAP_DATA(Packet *p) override;
+	NetworkRecvStatus Receive_SERVER_MAP_BULK(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_MAP_DONE(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_JOIN(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_FRAME(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_SYNC(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_COMMAND(Packet *p) override;
+	NetworkRecvStatus Receive_SERVER_COMMANDS(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_CHAT(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_QUIT(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_ERROR_QUIT(Packet *p) override;
@@ -70,6 +73,8 @@ protected:
 	NetworkRecvStatus Receive_SERVER_COMPANY_UPDATE(Packet *p) override;
 	NetworkRecvStatus Receive_SERVER_CONFIG_UPDATE(Packet *p) override;
 
+	void ReceiveRawData(const byte *data, size_t len) override;
+
 	static NetworkRecvStatus SendNewGRFsOk();
 	static NetworkRecvStatus SendGetMap();
 	static NetworkRecvStatus SendMapOk();
@@ -99,10 +104,12 @@ public:
 	static NetworkRecvStatus SendMove(CompanyID company, const char *password);
 
 	static bool IsConnected();
+	static SOCKET GetEventHandle();
 
 	static void Send();
 	static bool Receive();
 	static bool GameLoop();
+	static bool CatchUp();
 };
 
 /** Helper to make the code look somewhat nicer. */
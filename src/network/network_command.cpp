@@ -170,20 +170,24 @@ void NetworkSendCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, Comman
 }
 
 /**
- * Sync our local command queue to the command queue of the given
- * socket. This is needed for the case where we receive a command
- * before saving the game for a joining client, but without the
- * execution of those commands. Not syncing those commands means
- * that the client will never get them and as such will be in a
- * desynced state from the time it started with joining.
- * @param cs The client to sync the queue to.
+ * Sync our local command queue to the given command queue. This is
+ * needed for the case where we receive a command before saving the
+ * game for joining clients, but without the execution of those
+ * commands. Not syncing those commands means that the clients will
+ * never get them and as such will be in a desynced state from the
+ * time they started with joining. A relay has those commands in the
+ * queue of the commands it received from its server.
+ * @param queue The queue to sync to, the one of a map snapshot.
  */
-void NetworkSyncCommandQueue(NetworkClientSocket *cs)
+void NetworkSyncCommandQueue(CommandQueue *queue)
 {
-	for (CommandPacket *p = _local_execution_queue.Peek(); p != nullptr; p = p->next) {
+	CommandQueue &source = (_network_server ? _local_execution_queue : ClientNetworkGameSocketHandler::my_client->incoming_queue);
+
+	for (CommandPacket *p = source.Peek(); p != nullptr; p = p->next) {
 		CommandPacket c = *p;
 		c.callback = 0;
-		cs->outgoing_queue.Append(&c);
+		c.my_cmd = false;
+		queue->Append(&c);
 	}
 }
 
@@ -251,6 +255,9 @@ static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket
 		}
 	}
 
+	/* Clients that start downloading the map from the same snapshot later on need it too. */
+	NetworkMapSnapshotAddCommand(cp);
+
 	cp.callback = (cs != owner) ? nullptr : callback;
 	cp.my_cmd = (cs == owner);
 	_local_execution_queue.Append(&cp);
@@ -342,3 +349,102 @@ void NetworkGameSocketHandler::SendCommand(Packet *p, const CommandPacket *cp)
 	}
 	p->Send_uint8 (callback);
 }
+
+/** Flags telling how a command in a batch of commands is encoded. */
+enum BatchedCommandFlags {
+	BCF_MY_CMD       = 1 << 0, ///< The command originated from the receiving client.
+	BCF_SAME_COMPANY = 1 << 1, ///< The company is the same as that of the previous command, so it is not sent.
+	BCF_SAME_CMD     = 1 << 2, ///< The command is the same as that of the previous command, so it is not sent.
+	BCF_SAME_P1      = 1 << 3, ///< P1 is the same as that of the previous command, so it is not sent.
+	BCF_SAME_P2      = 1 << 4, ///< P2 is the same as that of the previous command, so it is not sent.
+	BCF_SAME_TILE    = 1 << 5, ///< The tile is the same as that of the previous command, so it is not sent.
+	BCF_HAS_TEXT     = 1 << 6, ///< The command has a text, which is sent.
+	BCF_HAS_CALLBACK = 1 << 7, ///< The command has a callback, which is sent.
+};
+
+/**
+ * Receives a command that is part of a batch of commands from the network.
+ * @param p the packet to read from.
+ * @param cp the struct to write the data to.
+ * @param prev the previously received command of the batch, or \c nullptr for the first command.
+ * @return an error message. When nullptr there has been no error.
+ */
+const char *NetworkGameSocketHandler::ReceiveBatchedCommand(Packet *p, CommandPacket *cp, const CommandPacket *prev)
+{
+	byte flags = p->Recv_uint8();
+	if (prev == nullptr && (flags & (BCF_SAME_COMPANY | BCF_SAME_CMD | BCF_SAME_P1 | BCF_SAME_P2 | BCF_SAME_TILE)) != 0) return "invalid command batch";
+
+	cp->my_cmd  = (flags & BCF_MY_CMD) != 0;
+	cp->company = (flags & BCF_SAME_COMPANY) != 0 ? prev->company : (CompanyID)p->Recv_uint8();
+	cp->cmd     = (flags & BCF_SAME_CMD) != 0 ? prev->cmd : p->Recv_uint32();
+	if (!IsValidCommand(cp->cmd))               return "invalid command";
+	if (GetCommandFlags(cp->cmd) & CMD_OFFLINE) return "offline only command";
+	if ((cp->cmd & CMD_FLAGS_MASK) != 0)        return "invalid command flag";
+
+	cp->p1      = (flags & BCF_SAME_P1) != 0 ? prev->p1 : p->Recv_uint32();
+	cp->p2      = (flags & BCF_SAME_P2) != 0 ? prev->p2 : p->Recv_uint32();
+	cp->tile    = (flags & BCF_SAME_TILE) != 0 ? prev->tile : p->Recv_uint32();
+	if ((flags & BCF_HAS_TEXT) != 0) {
+		p->Recv_string(cp->text, lengthof(cp->text), (!_network_server && GetCommandFlags(cp->cmd) & CMD_STR_CTRL) != 0 ? SVS_ALLOW_CONTROL_CODE | SVS_REPLACE_WITH_QUESTION_MARK : SVS_REPLACE_WITH_QUESTION_MARK);
+	} else {
+		cp->text[0] = '\0';
+	}
+
+	byte callback = (flags & BCF_HAS_CALLBACK) != 0 ? p->Recv_uint8() : 0;
+	if (callback >= lengthof(_callback_table))  return "invalid callback";
+
+	cp->callback = _callback_table[callback];
+	return nullptr;
+}
+
+/**
+ * Sends a command as part of a batch of commands over the network. Only the
+ * fields that differ from the previous command of the batch are sent.
+ * @param p the packet to send it in.
+ * @param cp the packet to actually send.
+ * @param prev the previously sent command of the batch, or \c nullptr for the first command.
+ * @return false when the command does not fit in the packet anymore; nothing is sent then.
+ */
+bool NetworkGameSocketHandler::SendBatchedCommand(Packet *p, const CommandPacket *cp, const CommandPacket *prev)
+{
+	byte callback = 0;
+	while (callback < lengthof(_callback_table) && _callback_table[callback] != cp->callback) {
+		callback++;
+	}
+
+	if (callback == lengthof(_callback_table)) {
+		DEBUG(net, 0, "Unknown callback. (Pointer: %p) No callback sent", cp->callback);
+		callback = 0; // _callback_table[0] == nullptr
+	}
+
+	byte flags = 0;
+	if (cp->my_cmd) flags |= BCF_MY_CMD;
+	if (prev != nullptr && cp->company == prev->company) flags |= BCF_SAME_COMPANY;
+	if (prev != nullptr && cp->cmd     == prev->cmd)     flags |= BCF_SAME_CMD;
+	if (prev != nullptr && cp->p1      == prev->p1)      flags |= BCF_SAME_P1;
+	if (prev != nullptr && cp->p2      == prev->p2)      flags |= BCF_SAME_P2;
+	if (prev != nullptr && cp->tile    == prev->tile)    flags |= BCF_SAME_TILE;
+	if (!StrEmpty(cp->text)) flags |= BCF_HAS_TEXT;
+	if (callback != 0)       flags |= BCF_HAS_CALLBACK;
+
+	size_t size = 1;
+	if ((flags & BCF_SAME_COMPANY) == 0) size += 1;
+	if ((flags & BCF_SAME_CMD)     == 0) size += 4;
+	if ((flags & BCF_SAME_P1)      == 0) size += 4;
+	if ((flags & BCF_SAME_P2)      == 0) size += 4;
+	if ((flags & BCF_SAME_TILE)    == 0) size += 4;
+	if ((flags & BCF_HAS_TEXT)     != 0) size += strlen(cp->text) + 1;
+	if ((flags & BCF_HAS_CALLBACK) != 0) size += 1;
+
+	if (p->size + size > SEND_MTU) return false;
+
+	p->Send_uint8(flags);
+	if ((flags & BCF_SAME_COMPANY) == 0) p->Send_uint8 (cp->company);
+	if ((flags & BCF_SAME_CMD)     == 0) p->Send_uint32(cp->cmd);
+	if ((flags & BCF_SAME_P1)      == 0) p->Send_uint32(cp->p1);
+	if ((flags & BCF_SAME_P2)      == 0) p->Send_uint32(cp->p2);
+	if ((flags & BCF_SAME_TILE)    == 0) p->Send_uint32(cp->tile);
+	if ((flags & BCF_HAS_TEXT)     != 0) p->Send_string(cp->text);
+	if ((flags & BCF_HAS_CALLBACK) != 0) p->Send_uint8 (callback);
+	return true;
+}
@@ -2024,6 +2024,8 @@ NetworkJoinStatus _network_join_status; ///< The status of joining.
 uint8 _network_join_waiting;            ///< The number of clients waiting in front of us.
 uint32 _network_join_bytes;             ///< The number of bytes we already downloaded.
 uint32 _network_join_bytes_total;       ///< The total number of bytes to download.
+uint32 _network_join_frames;            ///< The number of frames we already caught up with.
+uint32 _network_join_frames_total;      ///< The total number of frames to catch up with.
 
 struct NetworkJoinStatusWindow : Window {
 	NetworkPasswordType password_type;
@@ -2050,6 +2052,16 @@ struct NetworkJoinStatusWindow : Window {
 				DrawString(r.left + 2, r.right - 2, r.top + 20 + FONT_HEIGHT_NORMAL, STR_NETWORK_CONNECTING_WAITING, TC_FROMSTRING, SA_HOR_CENTER);
 				progress = 15; // third stage is 15%
 				break;
+			case NETWORK_JOIN_STATUS_PROCESSING:
+				if (!_network_catching_up || _network_join_frames_total == 0) {
+					progress = 100; // the map is complete
+					break;
+				}
+				SetDParam(0, _network_join_frames);
+				SetDParam(1, _network_join_frames_total);
+				DrawString(r.left + 2, r.right - 2, r.top + 20 + FONT_HEIGHT_NORMAL, STR_NETWORK_CONNECTING_CATCHING_UP, TC_FROMSTRING, SA_HOR_CENTER);
+				progress = (uint64)_network_join_frames * 100 / _network_join_frames_total;
+				break;
 			case NETWORK_JOIN_STATUS_DOWNLOADING:
 				SetDParam(0, _network_join_bytes);
 				SetDParam(1, _network_join_bytes_total);
@@ -2089,6 +2101,7 @@ struct NetworkJoinStatusWindow : Window {
 		SetDParamMaxDigits(1, 8);
 		width = max(width, GetStringBoundingBox(STR_NETWORK_CONNECTING_DOWNLOADING_1).width);
 		width = max(width, GetStringBoundingBox(STR_NETWORK_CONNECTING_DOWNLOADING_2).width);
+		width = max(width, GetStringBoundingBox(STR_NETWORK_CONNECTING_CATCHING_UP).width);
 
 		/* Give a bit more clearing for the widest strings than strictly needed */
 		size->width = width + WD_FRAMERECT_LEFT + WD_FRAMERECT_BOTTOM + 10;
@@ -120,11 +120,29 @@ extern uint32 _sync_seed_2;
 #endif
 extern uint32 _sync_frame;
 extern bool _network_first_time;
+
+/** The parts of the game state that are hashed to find out where clients diverged from the server. */
+enum NetworkSyncHash {
+	NSH_MAP,       ///< A region of the map.
+	NSH_COMPANIES, ///< The finances of the companies.
+	NSH_VEHICLES,  ///< The positions, speeds and cargo of the vehicles.
+	NSH_STATIONS,  ///< The cargo and ratings of the stations.
+	NSH_END,       ///< End marker.
+};
+
+/** The number of regions the map is split in for the sync hashes; every sync hashes one of them. */
+static const uint NETWORK_SYNC_HASH_MAP_REGIONS = 64;
+
+extern uint8 _sync_hash_region;
+extern uint32 _sync_hashes[NSH_END];
+extern bool _sync_hashes_valid;
 /* Vars needed for the join-GUI */
 extern NetworkJoinStatus _network_join_status;
 extern uint8 _network_join_waiting;
 extern uint32 _network_join_bytes;
 extern uint32 _network_join_bytes_total;
+extern uint32 _network_join_frames;
+extern uint32 _network_join_frames_total;
 
 extern uint8 _network_reconnect;
 
@@ -160,13 +178,16 @@ struct CommandPacket : CommandContainer {
 void NetworkDistributeCommands();
 void NetworkExecuteLocalCommandQueue();
 void NetworkFreeLocalCommandQueue();
-void NetworkSyncCommandQueue(NetworkClientSocket *cs);
+void NetworkSyncCommandQueue(CommandQueue *queue);
+void NetworkMapSnapshotAddCommand(const CommandPacket &cp);
 
 void NetworkError(StringID error_string);
 void NetworkTextMessage(NetworkAction action, TextColour colour, bool self_send, const char *name, const char *str = "", int64 data = 0);
 uint NetworkCalculateLag(const NetworkClientSocket *cs);
 StringID GetNetworkErrorMsg(NetworkErrorCode err);
 bool NetworkFindName(char *new_name, const char *last);
+void NetworkCalculateSyncHashes(uint region, uint32 hashes[NSH_END]);
+bool NetworkCheckSyncHashes(char *buf, const char *last);
 const char *GenerateCompanyPasswordHash(const char *password, const char *password_server_id, uint32 password_game_seed);
 
 #endif /* NETWORK_INTERNAL_H */
@@ -31,7 +31,7 @@
 #include "../core/random_func.hpp"
 #include "../rev.h"
 #include <mutex>
-#include <condition_variable>
+#include <atomic>
 
 #include "../safeguards.h"
 
@@ -41,6 +41,13 @@
 DECLARE_POSTFIX_INCREMENT(ClientID)
 /** The identifier counter for new clients (is never decreased) */
 static ClientID _network_client_id = CLIENT_ID_FIRST;
+/** The identifiers of the spectators of a relay start here, so they do not clash with the ones of the server's clients. */
+static const ClientID RELAY_CLIENT_ID_FIRST = (ClientID)(1 << 24);
+
+/** The map region that is hashed for the next sync packet we send. */
+static uint8 _sync_hash_send_region;
+/** The frame the spectators of the relay were last told they may run to. */
+static uint32 _relay_frame_counter_max;
 
 /** Make very sure the preconditions given in network_type.h are actually followed */
 assert_compile(MAX_CLIENT_SLOTS > MAX_CLIENTS);
@@ -53,153 +60,180 @@ INSTANTIATE_POOL_METHODS(NetworkClientSocket)
 
 /** Instantiate the listen sockets. */
 template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::sockets;
+#if defined(HAVE_EPOLL)
+template int TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::epoll_fd;
+#endif
 
-/** Writing a savegame directly to a number of packets. */
-struct PacketWriter : SaveFilter {
-	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
-	Packet *current;                    ///< The packet we're currently writing to.
-	size_t total_size;                  ///< Total size of the compressed savegame.
-	Packet *packets;                    ///< Packet queue of the savegame; send these "slowly" to the client.
-	std::mutex mutex;                   ///< Mutex for making threaded saving safe.
-	std::condition_variable exit_sig;   ///< Signal for threaded destruction of this packet writer.
+/**
+ * A compressed savegame that is shared by all clients that download the map at
+ * about the same time, so the world is only saved and compressed once for them.
+ * The saving thread appends to it, while the clients stream from it at their own pace.
+ */
+struct NetworkMapSnapshot {
+	static const size_t BLOCK_SIZE = 1024 * 1024; ///< Size of the blocks the savegame is stored in, and the maximum size of bulk frames.
+
+	uint32 frame;                                 ///< The frame the snapshot was made at.
+	uint clients;                                 ///< Number of clients streaming from this snapshot; only used by the main thread.
+	std::atomic<bool> abandoned;                  ///< Whether every client left before saving finished, so saving can be cancelled.
+	CommandQueue commands;                        ///< Commands for frames after the snapshot, for clients that start streaming later on.
+
+	std::mutex mutex;                             ///< Mutex for the data below, which is written by the saving thread.
+	std::vector<std::unique_ptr<byte[]>> blocks;  ///< The compressed savegame.
+	size_t size;                                  ///< Total size of the compressed savegame written so far.
+	bool finished;                                ///< Whether the savegame is complete.
+	bool failed;                                  ///< Whether saving failed.
 
 	/**
-	 * Create the packet writer.
-	 * @param cs The socket handler we're making the packets for.
+	 * Create the snapshot of the map at the current frame.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), current(nullptr), total_size(0), packets(nullptr)
+	NetworkMapSnapshot() : frame(_frame_counter), clients(0), abandoned(false), size(0), finished(false), failed(false)
 	{
+		/* Commands that have been distributed, but not executed yet. */
+		NetworkSyncCommandQueue(&this->commands);
 	}
 
-	/** Make sure everything is cleaned up. */
-	~PacketWriter()
+	/**
+	 * Record a command distributed after the snapshot has been made.
+	 * @param cp The command.
+	 */
+	void AddCommand(const CommandPacket &cp)
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
-
-		if (this->cs != nullptr) this->exit_sig.wait(lock);
-
-		/* This must all wait until the Destroy function is called. */
-
-		while (this->packets != nullptr) {
-			Packet *p = this->packets->next;
-			delete this->packets;
-			this->packets = p;
-		}
-
-		delete this->current;
+		CommandPacket c = cp;
+		c.callback = nullptr;
+		c.my_cmd = false;
+		this->commands.Append(&c);
 	}
 
 	/**
-	 * Begin the destruction of this packet writer. It can happen in two ways:
-	 * in the first case the client disconnected while saving the map. In this
-	 * case the saving has not finished and killed this PacketWriter. In that
-	 * case we simply set cs to nullptr, triggering the appending to fail due to
-	 * the connection problem and eventually triggering the destructor. In the
-	 * second case the destructor is already called, and it is waiting for our
-	 * signal which we will send. Only then the packets will be removed by the
-	 * destructor.
+	 * Copy a part of the compressed savegame.
+	 * @param pos Offset in the savegame to start at.
+	 * @param buf Buffer to copy to.
+	 * @param len Maximum number of bytes to copy.
+	 * @return Number of bytes copied; 0 when nothing is available (yet).
 	 */
-	void Destroy()
+	size_t Read(size_t pos, byte *buf, size_t len)
 	{
-		std::unique_lock<std::mutex> lock(this->mutex);
-
-		this->cs = nullptr;
-
-		this->exit_sig.notify_all();
-		lock.unlock();
+		std::lock_guard<std::mutex> lock(this->mutex);
 
-		/* Make sure the saving is completely cancelled. Yes,
-		 * we need to handle the save finish as well as the
-		 * next connection might just be requesting a map. */
-		WaitTillSaved();
-		ProcessAsyncSaveFinish();
+		if (pos >= this->size) return 0;
+		len = min(len, min(this->size - pos, BLOCK_SIZE - pos % BLOCK_SIZE));
+		memcpy(buf, this->blocks[pos / BLOCK_SIZE].get() + pos % BLOCK_SIZE, len);
+		return len;
 	}
 
 	/**
-	 * Checks whether there are packets.
-	 * It's not 100% threading safe, but this is only asked for when checking
-	 * whether there still is something to send. Then another call will be made
-	 * to actually get the Packet, which will be the only one popping packets
-	 * and thus eventually setting this on false.
+	 * Get a part of the compressed savegame without copying it. The data does
+	 * not move or change for as long as the snapshot exists.
+	 * @param pos  Offset in the savegame to start at.
+	 * @param[out] data The start of the data.
+	 * @return Number of bytes available at \a data; 0 when nothing is available (yet).
 	 */
-	bool HasPackets()
+	size_t GetData(size_t pos, const byte **data)
 	{
-		return this->packets != nullptr;
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (pos >= this->size) return 0;
+		*data = this->blocks[pos / BLOCK_SIZE].get() + pos % BLOCK_SIZE;
+		return min(this->size - pos, BLOCK_SIZE - pos % BLOCK_SIZE);
 	}
+};
+
+/** Writing a savegame into a shared map snapshot. */
+struct NetworkMapSnapshotWriter : SaveFilter {
+	std::shared_ptr<NetworkMapSnapshot> snapshot; ///< The snapshot we are writing to.
 
 	/**
-	 * Pop a single created packet from the queue with packets.
+	 * Create the snapshot writer.
+	 * @param snapshot The snapshot to write to.
 	 */
-	Packet *PopPacket()
+	NetworkMapSnapshotWriter(std::shared_ptr<NetworkMapSnapshot> snapshot) : SaveFilter(nullptr), snapshot(snapshot)
 	{
-		std::lock_guard<std::mutex> lock(this->mutex);
-
-		Packet *p = this->packets;
-		this->packets = p->next;
-		p->next = nullptr;
-
-		return p;
 	}
 
-	/** Append the current packet to the queue. */
-	void AppendQueue()
+	/** Tell the clients the savegame will never be complete, in case saving got cancelled. */
+	~NetworkMapSnapshotWriter()
 	{
-		if (this->current == nullptr) return;
-
-		Packet **p = &this->packets;
-		while (*p != nullptr) {
-			p = &(*p)->next;
-		}
-		*p = this->current;
-
-		this->current = nullptr;
+		std::lock_guard<std::mutex> lock(this->snapshot->mutex);
+		if (!this->snapshot->finished) this->snapshot->failed = true;
 	}
 
 	void Write(byte *buf, size_t size) override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when nobody is waiting for it anymore. */
+		if (this->snapshot->abandoned.load(std::memory_order_relaxed)) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
-		if (this->current == nullptr) this->current = new Packet(PACKET_SERVER_MAP_DATA);
+		std::lock_guard<std::mutex> lock(this->snapshot->mutex);
 
-		std::lock_guard<std::mutex> lock(this->mutex);
+		NetworkMapSnapshot *s = this->snapshot.get();
+		while (size != 0) {
+			size_t offset = s->size % NetworkMapSnapshot::BLOCK_SIZE;
+			if (offset == 0) s->blocks.emplace_back(new byte[NetworkMapSnapshot::BLOCK_SIZE]);
 
-		byte *bufe = buf + size;
-		while (buf != bufe) {
-			size_t to_write = min(SEND_MTU - this->current->size, bufe - buf);
-			memcpy(this->current->buffer + this->current->size, buf, to_write);
-			this->current->size += (PacketSize)to_write;
+			size_t to_write = min(NetworkMapSnapshot::BLOCK_SIZE - offset, size);
+			memcpy(s->blocks.back().get() + offset, buf, to_write);
+			s->size += to_write;
 			buf += to_write;
-
-			if (this->current->size == SEND_MTU) {
-				this->AppendQueue();
-				if (buf != bufe) this->current = new Packet(PACKET_SERVER_MAP_DATA);
-			}
+			size -= to_write;
 		}
-
-		this->total_size += size;
 	}
 
 	void Finish() override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		if (this->snapshot->abandoned.load(std::memory_order_relaxed)) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
-		std::lock_guard<std::mutex> lock(this->mutex);
+		std::lock_guard<std::mutex> lock(this->snapshot->mutex);
+		this->snapshot->finished = true;
+	}
+};
+
+/** The snapshot clients that request the map may start streaming from, if it is not too old. */
+static std::weak_ptr<NetworkMapSnapshot> _network_map_snapshot;
+
+/** Maximum age of a map snapshot, in ticks, for clients to start streaming from it. */
+static const uint MAP_SNAPSHOT_MAX_JOIN_AGE = DAY_TICKS * 2;
+
+/**
+ * Get the map snapshot a client that requests the map can start streaming from.
+ * @return The snapshot, or nullptr when there is none or it is too old.
+ */
+static std::shared_ptr<NetworkMapSnapshot> GetJoinableMapSnapshot()
+{
+	std::shared_ptr<NetworkMapSnapshot> snapshot = _network_map_snapshot.lock();
+	if (snapshot == nullptr || _frame_counter - snapshot->frame > MAP_SNAPSHOT_MAX_JOIN_AGE) return nullptr;
 
-		/* Make sure the last packet is flushed. */
-		this->AppendQueue();
+	std::lock_guard<std::mutex> lock(snapshot->mutex);
+	return snapshot->failed ? nullptr : snapshot;
+}
 
-		/* Add a packet stating that this is the end to the queue. */
-		this->current = new Packet(PACKET_SERVER_MAP_DONE);
-		this->AppendQueue();
+/**
+ * Record a command that has been distributed to the clients, so clients that start
+ * downloading the current map snapshot later on will get it as well.
+ * @param cp The command.
+ */
+void NetworkMapSnapshotAddCommand(const CommandPacket &cp)
+{
+	std::shared_ptr<NetworkMapSnapshot> snapshot = _network_map_snapshot.lock();
+	if (snapshot != nullptr && _frame_counter - snapshot->frame <= MAP_SNAPSHOT_MAX_JOIN_AGE) snapshot->AddCommand(cp);
+}
 
-		/* Fast-track the size to the client. */
-		Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
-		p->Send_uint32((uint32)this->total_size);
-		this->cs->NetworkTCPSocketHandler::SendPacket(p);
+/**
+ * Stop streaming the map snapshot to a client.
+ * @param cs The client.
+ */
+static void ReleaseMapSnapshot(NetworkClientSocket *cs)
+{
+	if (cs->savegame == nullptr) return;
+
+	if (--cs->savegame->clients == 0) {
+		std::lock_guard<std::mutex> lock(cs->savegame->mutex);
+		if (!cs->savegame->finished) {
+			/* Nobody is interested in the rest of this savegame anymore. */
+			cs->savegame->abandoned.store(true, std::memory_order_relaxed);
+			if (_network_map_snapshot.lock() == cs->savegame) _network_map_snapshot.reset();
+		}
 	}
-};
+	cs->savegame.reset();
+}
 
 
 /**
@@ -226,10 +260,7 @@ ServerNetworkGameSocketHandler::~ServerNetworkGameSocketHandler()
 	if (_redirect_console_to_client == this->client_id) _redirect_console_to_client = INVALID_CLIENT_ID;
 	OrderBackup::ResetUser(this->client_id);
 
-	if (this->savegame != nullptr) {
-		this->savegame->Destroy();
-		this->savegame = nullptr;
-	}
+	ReleaseMapSnapshot(this);
 }
 
 Packet *ServerNetworkGameSocketHandler::ReceivePacket()
@@ -245,6 +276,17 @@ Packet *ServerNetworkGameSocketHandler::ReceivePacket()
 	return p;
 }
 
+/**
+ * Close the connection to the client. Unlike for the game's client, this never
+ * drops us back to the main menu; a relay is not the server but does not want that either.
+ * @param error Whether we quit under an error condition or not.
+ * @return The new status of the connection.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(bool error)
+{
+	return this->CloseConnection(error ? NETWORK_RECV_STATUS_SERVER_ERROR : NETWORK_RECV_STATUS_CONN_LOST);
+}
+
 NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvStatus status)
 {
 	assert(status != NETWORK_RECV_STATUS_OKAY);
@@ -323,8 +365,6 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvSta
 	}
 }
 
-static void NetworkHandleCommandQueue(NetworkClientSocket *cs);
-
 /***********
  * Sending functions
  *   DEF_SERVER_SEND_COMMAND has parameter: NetworkClientSocket *cs
@@ -535,6 +575,15 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendWelcome()
 			this->SendClientInfo(new_cs->GetInfo());
 		}
 	}
+	if (_network_relay) {
+		/* Also send the info of the clients of the relayed server, which includes the relay itself */
+		NetworkClientInfo *ci;
+		FOR_ALL_CLIENT_INFOS(ci) {
+			if (ci->client_id < RELAY_CLIENT_ID_FIRST) this->SendClientInfo(ci);
+		}
+		return NETWORK_RECV_STATUS_OKAY;
+	}
+
 	/* Also send the info of the server */
 	return this->SendClientInfo(NetworkClientInfo::GetByClientID(CLIENT_ID_SERVER));
 }
@@ -561,78 +610,102 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendWait()
 /** This sends the map to the client */
 NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 {
-	static uint sent_packets; // How many packets we did send successfully last time
-
 	if (this->status < STATUS_AUTHORIZED) {
 		/* Illegal call, return error and ignore the packet */
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
 	if (this->status == STATUS_AUTHORIZED) {
-		this->savegame = new PacketWriter(this);
+		/* Stream the snapshot other clients are downloading, or make a new one. */
+		this->savegame = GetJoinableMapSnapshot();
+		bool new_snapshot = this->savegame == nullptr;
+		if (new_snapshot) {
+			this->savegame = std::make_shared<NetworkMapSnapshot>();
+			_network_map_snapshot = this->savegame;
+		}
+		this->savegame->clients++;
+		this->savegame_pos = 0;
+		this->savegame_size_sent = false;
 
-		/* Now send the _frame_counter and how many packets are coming */
+		/* Now send the frame of the snapshot and how many packets are coming */
 		Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN);
-		p->Send_uint32(_frame_counter);
+		p->Send_uint32(this->savegame->frame);
 		this->SendPacket(p);
 
-		NetworkSyncCommandQueue(this);
+		/* The client has to execute everything that happened since the snapshot was made. */
+		for (CommandPacket *cp = this->savegame->commands.Peek(); cp != nullptr; cp = cp->next) {
+			this->outgoing_queue.Append(cp);
+		}
 		this->status = STATUS_MAP;
 		/* Mark the start of download */
 		this->last_frame = _frame_counter;
 		this->last_frame_server = _frame_counter;
 
-		sent_packets = 4; // We start with trying 4 packets
+		this->savegame_window = 4; // We start with trying 4 packets
 
 		/* Make a dump of the current game */
-		if (SaveWithFilter(this->savegame, true) != SL_OK) usererror("network savedump failed");
+		if (new_snapshot && SaveWithFilter(new NetworkMapSnapshotWriter(this->savegame), true) != SL_OK) usererror("network savedump failed");
 	}
 
 	if (this->status == STATUS_MAP) {
-		bool last_packet = false;
-		bool has_packets = false;
-
-		for (uint i = 0; (has_packets = this->savegame->HasPackets()) && i < sent_packets; i++) {
-			Packet *p = this->savegame->PopPacket();
-			last_packet = p->buffer[2] == PACKET_SERVER_MAP_DONE;
+		NetworkMapSnapshot *snapshot = this->savegame.get();
+
+		size_t size;
+		bool finished;
+		{
+			std::lock_guard<std::mutex> lock(snapshot->mutex);
+			if (snapshot->failed) return this->SendError(NETWORK_ERROR_SAVEGAME_FAILED);
+			size = snapshot->size;
+			finished = snapshot->finished;
+		}
 
+		if (finished && !this->savegame_size_sent) {
+			/* Fast-track the size to the client. */
+			Packet *p = new Packet(PACKET_SERVER_MAP_SIZE);
+			p->Send_uint32((uint32)size);
 			this->SendPacket(p);
+			this->savegame_size_sent = true;
+		}
 
-			if (last_packet) {
-				/* There is no more data, so break the for */
-				break;
+		bool has_packets = this->savegame_pos != size;
+		if (this->savegame_bulk) {
+			/* Queue everything that is available; it is sent straight from the snapshot as fast as the connection allows. */
+			const byte *data;
+			size_t len;
+			while ((len = snapshot->GetData(this->savegame_pos, &data)) != 0) {
+				Packet *p = new Packet(PACKET_SERVER_MAP_BULK);
+				p->Send_uint32((uint32)len);
+				p->SetPayload(data, len, this->savegame);
+				this->SendPacket(p);
+				this->savegame_pos += len;
+			}
+		} else {
+			for (uint i = 0; this->savegame_pos != size && i < this->savegame_window; i++) {
+				Packet *p = new Packet(PACKET_SERVER_MAP_DATA);
+				size_t len;
+				while (p->size < SEND_MTU && (len = snapshot->Read(this->savegame_pos, p->buffer + p->size, SEND_MTU - p->size)) != 0) {
+					p->size += (PacketSize)len;
+					this->savegame_pos += len;
+				}
+				this->SendPacket(p);
 			}
 		}
 
-		if (last_packet) {
-			/* Done reading, make sure saving is done as well */
-			this->savegame->Destroy();
-			this->savegame = nullptr;
+		if (finished && this->savegame_pos == size) {
+			/* There is no more data, so tell the client that this is the end. */
+			this->SendPacket(new Packet(PACKET_SERVER_MAP_DONE));
+			ReleaseMapSnapshot(this);
 
 			/* Set the status to DONE_MAP, no we will wait for the client
 			 *  to send it is ready (maybe that happens like never ;)) */
 			this->status = STATUS_DONE_MAP;
 
-			/* Find the best candidate for joining, i.e. the first joiner. */
+			/* Let everyone that is waiting start downloading; they will share a snapshot. */
 			NetworkClientSocket *new_cs;
-			NetworkClientSocket *best = nullptr;
 			FOR_ALL_CLIENT_SOCKETS(new_cs) {
 				if (new_cs->status == STATUS_MAP_WAIT) {
-					if (best == nullptr || best->GetInfo()->join_date > new_cs->GetInfo()->join_date || (best->GetInfo()->join_date == new_cs->GetInfo()->join_date && best->client_id > new_cs->client_id)) {
-						best = new_cs;
-					}
-				}
-			}
-
-			/* Is there someone else to join? */
-			if (best != nullptr) {
-				/* Let the first start joining. */
-				best->status = STATUS_AUTHORIZED;
-				best->SendMap();
-
-				/* And update the rest. */
-				FOR_ALL_CLIENT_SOCKETS(new_cs) {
-					if (new_cs->status == STATUS_MAP_WAIT) new_cs->SendWait();
+					new_cs->status = STATUS_AUTHORIZED;
+					new_cs->SendMap();
 				}
 			}
 		}
@@ -642,8 +715,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				return NETWORK_RECV_STATUS_CONN_LOST;
 
 			case SPS_ALL_SENT:
-				/* All are sent, increase the sent_packets */
-				if (has_packets) sent_packets *= 2;
+				/* All are sent, increase the window */
+				if (has_packets) this->savegame_window *= 2;
 				break;
 
 			case SPS_PARTLY_SENT:
@@ -651,8 +724,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 				break;
 
 			case SPS_NONE_SENT:
-				/* Not everything is sent, decrease the sent_packets */
-				if (sent_packets > 1) sent_packets /= 2;
+				/* Not everything is sent, decrease the window */
+				if (this->savegame_window > 1) this->savegame_window /= 2;
 				break;
 		}
 	}
@@ -673,40 +746,75 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendJoin(ClientID client_id)
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
-/** Tell the client that they may run to a particular frame. */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame()
+/**
+ * Create the packet telling the clients that they may run to a particular frame.
+ * @return The packet, without the token.
+ */
+static Packet *CreateFramePacket()
 {
 	Packet *p = new Packet(PACKET_SERVER_FRAME);
 	p->Send_uint32(_frame_counter);
 	p->Send_uint32(_frame_counter_max);
 #ifdef ENABLE_NETWORK_SYNC_EVERY_FRAME
-	p->Send_uint32(_sync_seed_1);
+	p->Send_uint32(_random.state[0]);
 #ifdef NETWORK_SEND_DOUBLE_SEED
-	p->Send_uint32(_sync_seed_2);
+	p->Send_uint32(_random.state[1]);
 #endif
+#endif
+	return p;
+}
+
+/**
+ * Create the packet requesting the clients to sync.
+ * @return The packet.
+ */
+static Packet *CreateSyncPacket()
+{
+	Packet *p = new Packet(PACKET_SERVER_SYNC);
+	p->Send_uint32(_frame_counter);
+	/* The state after the last frame; a relay has no seeds of its own to send. */
+	p->Send_uint32(_random.state[0]);
+
+#ifdef NETWORK_SEND_DOUBLE_SEED
+	p->Send_uint32(_random.state[1]);
 #endif
 
+	/* Let the clients know what our game state looks like, so they can tell where they diverged.
+	 * This uses its own region counter, as a relay checks the hashes of its server as well. */
+	uint32 hashes[NSH_END];
+	NetworkCalculateSyncHashes(_sync_hash_send_region, hashes);
+	p->Send_uint8(_sync_hash_send_region);
+	for (uint i = 0; i < NSH_END; i++) p->Send_uint32(hashes[i]);
+	_sync_hash_send_region = (_sync_hash_send_region + 1) % NETWORK_SYNC_HASH_MAP_REGIONS;
+	return p;
+}
+
+/**
+ * Tell the client that they may run to a particular frame.
+ * @param frame The frame packet that is sent to all clients, or \c nullptr to create one.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame(Packet *frame)
+{
 	/* If token equals 0, we need to make a new token and send that. */
 	if (this->last_token == 0) {
+		Packet *p = CreateFramePacket();
 		this->last_token = InteractiveRandomRange(UINT8_MAX - 1) + 1;
 		p->Send_uint8(this->last_token);
+		this->SendPacket(p);
+		return NETWORK_RECV_STATUS_OKAY;
 	}
 
-	this->SendPacket(p);
+	this->SendPacket(frame != nullptr ? frame->Share() : CreateFramePacket());
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
-/** Request the client to sync. */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
+/**
+ * Request the client to sync.
+ * @param sync The sync packet that is sent to all clients, or \c nullptr to create one.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync(Packet *sync)
 {
-	Packet *p = new Packet(PACKET_SERVER_SYNC);
-	p->Send_uint32(_frame_counter);
-	p->Send_uint32(_sync_seed_1);
-
-#ifdef NETWORK_SEND_DOUBLE_SEED
-	p->Send_uint32(_sync_seed_2);
-#endif
-	this->SendPacket(p);
+	this->SendPacket(sync != nullptr ? sync->Share() : CreateSyncPacket());
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -727,17 +835,46 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommand(const CommandPacke
 }
 
 /**
- * Send a chat message.
+ * Send all queued commands to the client. Commands that are executed in the
+ * same frame are batched into as few packets as possible.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommands()
+{
+	CommandPacket *cp;
+	while ((cp = this->outgoing_queue.Pop()) != nullptr) {
+		CommandPacket *next = this->outgoing_queue.Peek();
+		if (next == nullptr || next->frame != cp->frame) {
+			/* There is nothing to batch this command with. */
+			this->SendCommand(cp);
+			free(cp);
+			continue;
+		}
+
+		Packet *p = new Packet(PACKET_SERVER_COMMANDS);
+		p->Send_uint32(cp->frame);
+		this->SendBatchedCommand(p, cp, nullptr);
+		while ((next = this->outgoing_queue.Peek()) != nullptr && next->frame == cp->frame && this->SendBatchedCommand(p, next, cp)) {
+			free(cp);
+			cp = this->outgoing_queue.Pop();
+		}
+		free(cp);
+
+		this->SendPacket(p);
+	}
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Create a chat message packet.
  * @param action The action associated with the message.
  * @param client_id The origin of the chat message.
  * @param self_send Whether we did send the message.
  * @param msg The actual message.
  * @param data Arbitrary extra data.
+ * @return The packet.
  */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendChat(NetworkAction action, ClientID client_id, bool self_send, const char *msg, int64 data)
+static Packet *CreateChatPacket(NetworkAction action, ClientID client_id, bool self_send, const char *msg, int64 data)
 {
-	if (this->status < STATUS_PRE_ACTIVE) return NETWORK_RECV_STATUS_OKAY;
-
 	Packet *p = new Packet(PACKET_SERVER_CHAT);
 
 	p->Send_uint8 (action);
@@ -745,8 +882,22 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendChat(NetworkAction action,
 	p->Send_bool  (self_send);
 	p->Send_string(msg);
 	p->Send_uint64(data);
+	return p;
+}
 
-	this->SendPacket(p);
+/**
+ * Send a chat message.
+ * @param action The action associated with the message.
+ * @param client_id The origin of the chat message.
+ * @param self_send Whether we did send the message.
+ * @param msg The actual message.
+ * @param data Arbitrary extra data.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendChat(NetworkAction action, ClientID client_id, bool self_send, const char *msg, int64 data)
+{
+	if (this->status < STATUS_PRE_ACTIVE) return NETWORK_RECV_STATUS_OKAY;
+
+	this->SendPacket(CreateChatPacket(action, client_id, self_send, msg, data));
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -905,6 +1056,12 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_JOIN(Packet *p)
 
 	if (this->HasClientQuit()) return NETWORK_RECV_STATUS_CONN_LOST;
 
+	if (_network_relay) {
+		/* The clients of a relay can only watch; the clients of the server take places in the pool too. */
+		playas = COMPANY_SPECTATOR;
+		if (!NetworkClientInfo::CanAllocateItem()) return this->SendError(NETWORK_ERROR_FULL);
+	}
+
 	/* join another company does not affect these values */
 	switch (playas) {
 		case COMPANY_NEW_COMPANY: // New company
@@ -1010,12 +1167,17 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_GETMAP(Packet *
 		return this->SendError(NETWORK_ERROR_NOT_AUTHORIZED);
 	}
 
-	/* Check if someone else is receiving the map */
-	FOR_ALL_CLIENT_SOCKETS(new_cs) {
-		if (new_cs->status == STATUS_MAP) {
-			/* Tell the new client to wait */
-			this->status = STATUS_MAP_WAIT;
-			return this->SendWait();
+	/* Clients that don't tell us get the map in packets. */
+	this->savegame_bulk = p->pos < p->size && p->Recv_bool();
+
+	/* Check if someone else is receiving a map snapshot we can't share anymore */
+	if (GetJoinableMapSnapshot() == nullptr) {
+		FOR_ALL_CLIENT_SOCKETS(new_cs) {
+			if (new_cs->status == STATUS_MAP) {
+				/* Tell the new client to wait */
+				this->status = STATUS_MAP_WAIT;
+				return this->SendWait();
+			}
 		}
 	}
 
@@ -1037,7 +1199,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_MAP_OK(Packet *
 		/* Mark the client as pre-active, and wait for an ACK
 		 *  so we know he is done loading and in sync with us */
 		this->status = STATUS_PRE_ACTIVE;
-		NetworkHandleCommandQueue(this);
+		this->SendCommands();
 		this->SendFrame();
 		this->SendSync();
 
@@ -1078,6 +1240,12 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_COMMAND(Packet
 		return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
 	}
 
+	/* A relay only passes on the commands of its server. */
+	if (_network_relay) {
+		DEBUG(net, 1, "[relay] dropping command from client %d", this->client_id);
+		return NETWORK_RECV_STATUS_OKAY;
+	}
+
 	if (this->incoming_queue.Count() >= _settings_client.network.max_commands_in_queue) {
 		return this->SendError(NETWORK_ERROR_TOO_MANY_COMMANDS);
 	}
@@ -1349,10 +1517,13 @@ void NetworkServerSendChat(NetworkAction action, DestType desttype, int dest, co
 			DEBUG(net, 0, "[server] received unknown chat destination type %d. Doing broadcast instead", desttype);
 			FALLTHROUGH;
 
-		case DESTTYPE_BROADCAST:
+		case DESTTYPE_BROADCAST: {
+			/* Everybody gets the same message, so all clients share one packet. */
+			Packet *p = CreateChatPacket(action, from_id, false, msg, data);
 			FOR_ALL_CLIENT_SOCKETS(cs) {
-				cs->SendChat(action, from_id, false, msg, data);
+				if (cs->status >= NetworkClientSocket::STATUS_PRE_ACTIVE) cs->SendPacket(p->Share());
 			}
+			delete p;
 
 			NetworkAdminChat(action, desttype, from_id, msg, data, from_admin);
 
@@ -1361,6 +1532,7 @@ void NetworkServerSendChat(NetworkAction action, DestType desttype, int dest, co
 				NetworkTextMessage(action, GetDrawStringCompanyColour(ci->client_playas), false, ci->client_name, msg, data);
 			}
 			break;
+		}
 	}
 }
 
@@ -1379,6 +1551,9 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_CHAT(Packet *p)
 	p->Recv_string(msg, NETWORK_CHAT_LENGTH);
 	int64 data = p->Recv_uint64();
 
+	/* The chat of the server is not relayed, so neither is the chat of the relay's clients. */
+	if (_network_relay) return NETWORK_RECV_STATUS_OKAY;
+
 	NetworkClientInfo *ci = this->GetInfo();
 	switch (action) {
 		case NETWORK_ACTION_GIVE_MONEY:
@@ -1468,6 +1643,9 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_MOVE(Packet *p)
 {
 	if (this->status != STATUS_ACTIVE) return this->SendError(NETWORK_ERROR_NOT_EXPECTED);
 
+	/* The clients of a relay can only be spectators. */
+	if (_network_relay) return NETWORK_RECV_STATUS_OKAY;
+
 	CompanyID company_id = (Owner)p->Recv_uint8();
 
 	/* Check if the company is valid, we don't allow moving to AI companies */
@@ -1772,20 +1950,7 @@ void NetworkServerSetCompanyPassword(CompanyID company_id, const char *password,
 }
 
 /**
- * Handle the command-queue of a socket.
- * @param cs The socket to handle the queue for.
- */
-static void NetworkHandleCommandQueue(NetworkClientSocket *cs)
-{
-	CommandPacket *cp;
-	while ((cp = cs->outgoing_queue.Pop()) != nullptr) {
-		cs->SendCommand(cp);
-		free(cp);
-	}
-}
-
-/**
- * This is called every tick if this is a _network_server
+ * This is called every tick if this is a _network_server, or a _network_relay
  * @param send_frame Whether to send the frame to the clients.
  */
 void NetworkServer_Tick(bool send_frame)
@@ -1800,7 +1965,11 @@ void NetworkServer_Tick(bool send_frame)
 		_last_sync_frame = _frame_counter;
 		send_sync = true;
 	}
+	/* The sync packet is the same for every client, so they all share one buffer. */
+	Packet *sync = send_sync ? CreateSyncPacket() : nullptr;
 #endif
+	/* The same goes for the frame packet, unless a client needs a new token. */
+	Packet *frame = send_frame ? CreateFramePacket() : nullptr;
 
 	/* Now we are done with the frame, inform the clients that they can
 	 *  do their frame! */
@@ -1897,22 +2066,110 @@ void NetworkServer_Tick(bool send_frame)
 
 		if (cs->status >= NetworkClientSocket::STATUS_PRE_ACTIVE) {
 			/* Check if we can send command, and if we have anything in the queue */
-			NetworkHandleCommandQueue(cs);
+			cs->SendCommands();
 
 			/* Send an updated _frame_counter_max to the client */
-			if (send_frame) cs->SendFrame();
+			if (send_frame) cs->SendFrame(frame);
 
 #ifndef ENABLE_NETWORK_SYNC_EVERY_FRAME
 			/* Send a sync-check packet */
-			if (send_sync) cs->SendSync();
+			if (send_sync) cs->SendSync(sync);
 #endif
 		}
 	}
 
+	delete frame;
+#ifndef ENABLE_NETWORK_SYNC_EVERY_FRAME
+	delete sync;
+#endif
+
 	/* See if we need to advertise */
 	NetworkUDPAdvertise();
 }
 
+/**
+ * Start relaying the game of the server we joined to spectators. From here on
+ * they get the map, the commands and the frames of the server from us, as if
+ * we were the server; only we do not take any commands from them.
+ * @return Whether we are listening for spectators.
+ */
+bool NetworkRelayStart()
+{
+	DEBUG(net, 1, "starting listeners for spectators");
+	if (!ServerNetworkGameSocketHandler::Listen(_settings_client.network.server_port)) return false;
+
+	extern byte _network_clients_connected;
+	_network_clients_connected = 0;
+	_network_game_info.clients_on = 0;
+	_network_client_id = RELAY_CLIENT_ID_FIRST;
+	_last_sync_frame = _frame_counter;
+	_relay_frame_counter_max = _frame_counter_max;
+	_network_relay = true;
+	return true;
+}
+
+/**
+ * Pass a command received from the server on to the spectators of the relay.
+ * @param cp The command.
+ */
+void NetworkRelayCommand(const CommandPacket &cp)
+{
+	CommandPacket c = cp;
+	c.callback = nullptr;
+	c.my_cmd = false;
+
+	NetworkClientSocket *cs;
+	FOR_ALL_CLIENT_SOCKETS(cs) {
+		if (cs->status >= NetworkClientSocket::STATUS_MAP) cs->outgoing_queue.Append(&c);
+	}
+
+	/* Spectators that start downloading the map from the same snapshot later on need it too. */
+	NetworkMapSnapshotAddCommand(c);
+}
+
+/**
+ * Pass the info of a client of the server on to the spectators of the relay.
+ * @param ci The info of the client.
+ */
+void NetworkRelayClientInfo(NetworkClientInfo *ci)
+{
+	NetworkClientSocket *cs;
+	FOR_ALL_CLIENT_SOCKETS(cs) {
+		if (cs->status >= NetworkClientSocket::STATUS_AUTHORIZED) cs->SendClientInfo(ci);
+	}
+}
+
+/**
+ * Tell the spectators of the relay that a client of the server has left.
+ * @param client_id The client that left.
+ * @param errorno The error that made the client leave, or #NETWORK_ERROR_END when it simply quit.
+ */
+void NetworkRelayClientQuit(ClientID client_id, NetworkErrorCode errorno)
+{
+	NetworkClientSocket *cs;
+	FOR_ALL_CLIENT_SOCKETS(cs) {
+		if (cs->status < NetworkClientSocket::STATUS_AUTHORIZED) continue;
+
+		if (errorno == NETWORK_ERROR_END) {
+			cs->SendQuit(client_id);
+		} else {
+			cs->SendErrorQuit(client_id, errorno);
+		}
+	}
+}
+
+/**
+ * This is called every tick if this is a _network_relay, after the frame of
+ * the server has been executed. The spectators may run as far as we may.
+ */
+void NetworkRelay_Tick()
+{
+	bool send_frame = _frame_counter_max != _relay_frame_counter_max;
+	_relay_frame_counter_max = _frame_counter_max;
+
+	NetworkServer_Tick(send_frame);
+}
+
 /** Yearly "callback". Called whenever the year changes. */
 void NetworkServerYearlyLoop()
 {
@@ -72,13 +72,19 @@ public:
 	CommandQueue outgoing_queue; ///< The command-queue awaiting delivery
 	int receive_limit;           ///< Amount of bytes that we can receive at this moment
 
-	struct PacketWriter *savegame; ///< Writer used to write the savegame.
+	std::shared_ptr<struct NetworkMapSnapshot> savegame; ///< Snapshot of the map the client is downloading.
+	size_t savegame_pos;           ///< Amount of the snapshot that has been sent to the client.
+	uint savegame_window;          ///< Number of packets of the snapshot to try to send at once.
+	bool savegame_size_sent;       ///< Whether the client has been told the size of the snapshot.
+	bool savegame_bulk;            ///< Whether the client can receive the snapshot in bulk frames.
 	NetworkAddress client_address; ///< IP-address of the client (so he can be banned)
 
 	ServerNetworkGameSocketHandler(SOCKET s);
 	~ServerNetworkGameSocketHandler();
 
 	virtual Packet *ReceivePacket() override;
+	bool CanReceivePacket() const override { return this->receive_limit > 0; }
+	NetworkRecvStatus CloseConnection(bool error = true) override;
 	NetworkRecvStatus CloseConnection(NetworkRecvStatus status) override;
 	void GetClientName(char *client_name, const char *last) const;
 
@@ -94,9 +100,10 @@ public:
 	NetworkRecvStatus SendError(NetworkErrorCode error);
 	NetworkRecvStatus SendChat(NetworkAction action, ClientID client_id, bool self_send, const char *msg, int64 data);
 	NetworkRecvStatus SendJoin(ClientID client_id);
-	NetworkRecvStatus SendFrame();
-	NetworkRecvStatus SendSync();
+	NetworkRecvStatus SendFrame(Packet *frame = nullptr);
+	NetworkRecvStatus SendSync(Packet *sync = nullptr);
 	NetworkRecvStatus SendCommand(const CommandPacket *cp);
+	NetworkRecvStatus SendCommands();
 	NetworkRecvStatus SendCompanyUpdate();
 	NetworkRecvStatus SendConfigUpdate();
 
@@ -119,6 +126,11 @@ public:
 };
 
 void NetworkServer_Tick(bool send_frame);
+bool NetworkRelayStart();
+void NetworkRelayCommand(const CommandPacket &cp);
+void NetworkRelayClientInfo(NetworkClientInfo *ci);
+void NetworkRelayClientQuit(ClientID client_id, NetworkErrorCode errorno);
+void NetworkRelay_Tick();
 void NetworkServerSetCompanyPassword(CompanyID company_id, const char *password, bool already_hashed = true);
 void NetworkServerUpdateCompanyPassworded(CompanyID company_id, bool passworded);
 
@@ -34,6 +34,7 @@
 #include "date_func.h"
 #include "newgrf_debug.h"
 #include "vehicle_func.h"
+#include "station_func.h"
 
 #include "table/strings.h"
 #include "table/object_land.h"
@@ -126,6 +127,7 @@ void BuildObject(ObjectType type, TileIndex tile, CompanyID owner, Town *town, u
 		MakeObject(t, owner, o->index, wc, Random());
 		MarkTileDirtyByTile(t);
 	}
+	AddAcceptanceTilesToStations(ta);
 
 	Object::IncTypeCount(type);
 	if (spec->flags & OBJECT_FLAG_ANIMATION) TriggerObjectAnimation(o, OAT_BUILT, spec);
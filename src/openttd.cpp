@@ -66,6 +66,7 @@
 #include "viewport_func.h"
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
+#include "command_replay.h"
 
 #include "linkgraph/linkgraphschedule.h"
 
@@ -171,6 +172,7 @@ static void ShowHelp()
 		"  -p password         = Password to join server\n"
 		"  -P password         = Password to join company\n"
 		"  -D [ip][:port]      = Start dedicated server\n"
+		"                        (with -n: relay that game to spectators)\n"
 		"  -l ip[:port]        = Redirect DEBUG()\n"
 #if !defined(_WIN32)
 		"  -f                  = Fork into the background (dedicated only)\n"
@@ -181,6 +183,7 @@ static void ShowHelp()
 		"  -c config_file      = Use 'config_file' instead of 'openttd.cfg'\n"
 		"  -x                  = Do not automatically save to config file on exit\n"
 		"  -q savegame         = Write some information about the savegame and exit\n"
+		"  -R recording        = Replay a command recording as fast as possible and exit\n"
 		"\n",
 		lastof(buf)
 	);
@@ -222,35 +225,43 @@ static void ShowHelp()
 #endif
 }
 
-static void WriteSavegameInfo(const char *name)
+/**
+ * Write the summary of a savegame to the console, for the -q command line option.
+ * @param name    Name of the savegame.
+ * @param summary The summary of the savegame.
+ */
+static void WriteSavegameInfo(const char *name, const SavegameSummary &summary)
 {
-	extern SaveLoadVersion _sl_version;
-	uint32 last_ottd_rev = 0;
-	byte ever_modified = 0;
-	bool removed_newgrfs = false;
-
-	GamelogInfo(_load_check_data.gamelog_action, _load_check_data.gamelog_actions, &last_ottd_rev, &ever_modified, &removed_newgrfs);
+	YearMonthDay ymd;
+	ConvertDateToYMD(summary.date, &ymd);
 
 	char buf[8192];
 	char *p = buf;
 	p += seprintf(p, lastof(buf), "Name:         %s\n", name);
-	p += seprintf(p, lastof(buf), "Savegame ver: %d\n", _sl_version);
-	p += seprintf(p, lastof(buf), "NewGRF ver:   0x%08X\n", last_ottd_rev);
-	p += seprintf(p, lastof(buf), "Modified:     %d\n", ever_modified);
+	p += seprintf(p, lastof(buf), "Savegame ver: %d\n", summary.version);
+	p += seprintf(p, lastof(buf), "NewGRF ver:   0x%08X\n", summary.last_ottd_rev);
+	p += seprintf(p, lastof(buf), "Modified:     %d\n", summary.ever_modified);
+	p += seprintf(p, lastof(buf), "Date:         %04d-%02d-%02d\n", ymd.year, ymd.month + 1, ymd.day);
+	p += seprintf(p, lastof(buf), "Map size:     %ux%u\n", summary.map_size_x, summary.map_size_y);
 
-	if (removed_newgrfs) {
+	if (summary.removed_newgrfs) {
 		p += seprintf(p, lastof(buf), "NewGRFs have been removed\n");
 	}
 
-	p = strecpy(p, "NewGRFs:\n", lastof(buf));
-	if (_load_check_data.HasNewGrfs()) {
-		for (GRFConfig *c = _load_check_data.grfconfig; c != nullptr; c = c->next) {
-			char md5sum[33];
-			md5sumToString(md5sum, lastof(md5sum), HasBit(c->flags, GCF_COMPATIBLE) ? c->original_md5sum : c->ident.md5sum);
-			p += seprintf(p, lastof(buf), "%08X %s %s\n", c->ident.grfid, md5sum, c->filename);
+	if (!summary.companies.empty()) {
+		p = strecpy(p, "Companies:\n", lastof(buf));
+		for (const SavegameSummaryCompany &c : summary.companies) {
+			p += seprintf(p, lastof(buf), "%2d %d " OTTD_PRINTF64 " %s\n", c.index + 1, c.inaugurated_year, (int64)c.money, c.name.c_str());
 		}
 	}
 
+	p = strecpy(p, "NewGRFs:\n", lastof(buf));
+	for (const SavegameSummaryGRF &grf : summary.grfs) {
+		char md5sum[33];
+		md5sumToString(md5sum, lastof(md5sum), grf.md5sum);
+		p += seprintf(p, lastof(buf), "%08X %s %s\n", grf.grfid, md5sum, grf.filename.c_str());
+	}
+
 	/* ShowInfo put output to stderr, but version information should go
 	 * to stdout; this is the only exception */
 #if !defined(_WIN32)
@@ -260,6 +271,31 @@ static void WriteSavegameInfo(const char *name)
 #endif
 }
 
+/**
+ * Create a summary from the check data of a savegame that was saved without one.
+ * Company names are not included, as the strings to generate them are not loaded at this point.
+ * @param summary The summary to fill.
+ */
+static void GetSavegameSummaryFromLoadCheckData(SavegameSummary *summary)
+{
+	extern SaveLoadVersion _sl_version;
+
+	summary->version = _sl_version;
+	summary->date = _load_check_data.current_date;
+	summary->map_size_x = _load_check_data.map_size_x;
+	summary->map_size_y = _load_check_data.map_size_y;
+	GamelogInfo(_load_check_data.gamelog_action, _load_check_data.gamelog_actions, &summary->last_ottd_rev, &summary->ever_modified, &summary->removed_newgrfs);
+
+	if (!_load_check_data.HasNewGrfs()) return;
+	for (const GRFConfig *c = _load_check_data.grfconfig; c != nullptr; c = c->next) {
+		SavegameSummaryGRF grf;
+		grf.grfid = c->ident.grfid;
+		MemCpyT(grf.md5sum, HasBit(c->flags, GCF_COMPATIBLE) ? c->original_md5sum : c->ident.md5sum, lengthof(grf.md5sum));
+		grf.filename = c->filename;
+		summary->grfs.push_back(grf);
+	}
+}
+
 
 /**
  * Extract the resolution from the given string and store
@@ -465,11 +501,11 @@ struct AfterNewGRFScan : NewGRFScanCallback {
 			const char *port = nullptr;
 			const char *company = nullptr;
 			uint16 rport = NETWORK_DEFAULT_PORT;
-			CompanyID join_as = COMPANY_NEW_COMPANY;
+			CompanyID join_as = _is_network_relay ? COMPANY_SPECTATOR : COMPANY_NEW_COMPANY;
 
 			ParseConnectionString(&company, &port, network_conn);
 
-			if (company != nullptr) {
+			if (company != nullptr && !_is_network_relay) {
 				join_as = (CompanyID)atoi(company);
 
 				if (join_as != COMPANY_SPECTATOR) {
@@ -522,6 +558,7 @@ static const OptionData _options[] = {
 	 GETOPT_SHORT_VALUE('c'),
 	 GETOPT_SHORT_NOVAL('x'),
 	 GETOPT_SHORT_VALUE('q'),
+	 GETOPT_SHORT_VALUE('R'),
 	 GETOPT_SHORT_NOVAL('h'),
 	GETOPT_END()
 };
@@ -638,6 +675,15 @@ int openttd_main(int argc, char *argv[])
 				scanner->generation_seed = InteractiveRandom();
 			}
 			break;
+		case 'R':
+			/* Replaying is headless, unless asked otherwise. */
+			if (musicdriver == nullptr) musicdriver = stredup("null");
+			if (sounddriver == nullptr) sounddriver = stredup("null");
+			if (videodriver == nullptr) videodriver = stredup("null");
+
+			_file_to_saveload.SetName(mgo.opt);
+			_switch_mode = SM_REPLAY;
+			break;
 		case 'q': {
 			DeterminePaths(argv[0]);
 			if (StrEmpty(mgo.opt)) {
@@ -649,6 +695,13 @@ int openttd_main(int argc, char *argv[])
 			title[0] = '\0';
 			FiosGetSavegameListCallback(SLO_LOAD, mgo.opt, strrchr(mgo.opt, '.'), title, lastof(title));
 
+			/* Savegames with a summary can be described without loading them. */
+			SavegameSummary summary;
+			if (FiosGetSavegameSummary(mgo.opt, SAVE_DIR, &summary)) {
+				WriteSavegameInfo(title, summary);
+				goto exit_noshutdown;
+			}
+
 			_load_check_data.Clear();
 			SaveOrLoadResult res = SaveOrLoad(mgo.opt, SLO_CHECK, DFT_GAME_FILE, SAVE_DIR, false);
 			if (res != SL_OK || _load_check_data.HasErrors()) {
@@ -662,7 +715,8 @@ int openttd_main(int argc, char *argv[])
 				goto exit_noshutdown;
 			}
 
-			WriteSavegameInfo(title);
+			GetSavegameSummaryFromLoadCheckData(&summary);
+			WriteSavegameInfo(title, summary);
 
 			goto exit_noshutdown;
 		}
@@ -698,6 +752,9 @@ int openttd_main(int argc, char *argv[])
 	if (dedicated) DEBUG(net, 0, "Starting dedicated version %s", _openttd_revision);
 	if (_dedicated_forks && !dedicated) _dedicated_forks = false;
 
+	/* A dedicated server that joins another server relays the game of that server. */
+	_is_network_relay = dedicated && scanner->network_conn != nullptr;
+
 #if defined(UNIX)
 	/* We must fork here, or we'll end up without some resources we need (like sockets) */
 	if (_dedicated_forks) DedicatedFork();
@@ -859,6 +916,8 @@ int openttd_main(int argc, char *argv[])
 
 	VideoDriver::GetInstance()->MainLoop();
 
+	StopCommandRecording();
+
 	WaitTillSaved();
 	WaitTillGeneratedWorld(); // Make sure any generate world threads have been joined.
 
@@ -1045,8 +1104,11 @@ void SwitchToMode(SwitchMode new_mode)
 {
 	/* If we are saving something, the network stays in his current state */
 	if (new_mode != SM_SAVE_GAME) {
+		/* A recording only makes sense for the game it started in */
+		StopCommandRecording();
+
 		/* If the network is active, make it not-active */
-		if (_networking) {
+		if (_networking || _network_relay) {
 			if (_network_server && (new_mode == SM_LOAD_GAME || new_mode == SM_NEWGAME || new_mode == SM_RESTARTGAME)) {
 				NetworkReboot();
 			} else {
@@ -1054,10 +1116,16 @@ void SwitchToMode(SwitchMode new_mode)
 			}
 		}
 
+		/* A relay has nothing left to do once it lost the game of its server */
+		if (_is_network_relay && new_mode == SM_MENU) {
+			DEBUG(net, 0, "Lost the game of the server, stopping the relay");
+			_exit_game = true;
+		}
+
 		/* If we are a server, we restart the server */
 		if (_is_network_server) {
-			/* But not if we are going to the menu */
-			if (new_mode != SM_MENU) {
+			/* But not if we are going to the menu or replaying */
+			if (new_mode != SM_MENU && new_mode != SM_REPLAY) {
 				/* check if we should reload the config */
 				if (_settings_client.network.reload_cfg) {
 					LoadFromConfig();
@@ -1114,6 +1182,14 @@ void SwitchToMode(SwitchMode new_mode)
 			break;
 		}
 
+		case SM_REPLAY: // Replay a command recording and quit
+			ResetGRFConfig(true);
+			ResetWindowSystem();
+
+			RunCommandReplay(_file_to_saveload.name);
+			_exit_game = true;
+			break;
+
 		case SM_START_HEIGHTMAP: // Load a heightmap and start a new game from it
 			if (_network_server) {
 				seprintf(_network_game_info.map_name, lastof(_network_game_info.map_name), "%s (Heightmap)", _file_to_saveload.title);
@@ -1327,6 +1403,23 @@ static void CheckCaches()
 	}
 }
 
+/**
+ * Run the AIs and the game script, or replay the commands they executed during the recording.
+ * @param paused Whether the game is paused, in which case only the game script runs.
+ */
+static void ScriptsGameLoop(bool paused)
+{
+	if (IsReplayingCommands()) {
+		ReplayCommands(CRP_SCRIPTS);
+		return;
+	}
+
+	Backup<CommandReplayPhase> phase(_command_replay_phase, CRP_SCRIPTS, FILE_LINE);
+	if (!paused) AI::GameLoop();
+	Game::GameLoop();
+	phase.Restore();
+}
+
 /**
  * State controlling game loop.
  * The state must not be changed from anywhere but here.
@@ -1334,6 +1427,9 @@ static void CheckCaches()
  */
 void StateGameLoop()
 {
+	CommandReplayTick();
+	Backup<CommandReplayPhase> phase(_command_replay_phase, CRP_GAME_LOOP, FILE_LINE);
+
 	/* don't execute the state loop during pause */
 	if (_pause_mode != PM_UNPAUSED) {
 		PerformanceMeasurer::Paused(PFE_GAMELOOP);
@@ -1346,14 +1442,18 @@ void StateGameLoop()
 
 		UpdateLandscapingLimits();
 #ifndef DEBUG_DUMP_COMMANDS
-		Game::GameLoop();
+		ScriptsGameLoop(true);
 #endif
+		phase.Restore();
 		return;
 	}
 
 	PerformanceMeasurer framerate(PFE_GAMELOOP);
 	PerformanceAccumulator::Reset(PFE_GL_LANDSCAPE);
-	if (HasModalProgress()) return;
+	if (HasModalProgress()) {
+		phase.Restore();
+		return;
+	}
 
 	Layouter::ReduceLineCache();
 
@@ -1392,8 +1492,7 @@ void StateGameLoop()
 #ifndef DEBUG_DUMP_COMMANDS
 		{
 			PerformanceMeasurer framerate(PFE_ALLSCRIPTS);
-			AI::GameLoop();
-			Game::GameLoop();
+			ScriptsGameLoop(false);
 		}
 #endif
 		UpdateLandscapingLimits();
@@ -1403,6 +1502,7 @@ void StateGameLoop()
 		cur_company.Restore();
 	}
 
+	phase.Restore();
 	assert(IsLocalCompany());
 }
 
@@ -1426,8 +1526,17 @@ static void DoAutosave()
 		if (++_autosave_ctr >= _settings_client.gui.max_num_autosaves) _autosave_ctr = 0;
 	}
 
+	/* Only every so many autosaves is complete; the others only contain the differences with the last complete one. */
+	SaveDeltaMode delta = SDM_NONE;
+	if (_settings_client.gui.autosave_full_interval != 0) {
+		static uint _autosaves_since_full = 0;
+
+		delta = (_autosaves_since_full == 0) ? SDM_CHECKPOINT : SDM_DELTA;
+		if (++_autosaves_since_full >= _settings_client.gui.autosave_full_interval) _autosaves_since_full = 0;
+	}
+
 	DEBUG(sl, 2, "Autosaving to '%s'", buf);
-	if (SaveOrLoad(buf, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR) != SL_OK) {
+	if (SaveOrLoad(buf, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR, true, delta) != SL_OK) {
 		ShowErrorMessage(STR_ERROR_AUTOSAVE_FAILED, INVALID_STRING_ID, WL_ERROR);
 	}
 }
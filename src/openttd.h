@@ -36,6 +36,7 @@ enum SwitchMode {
 	SM_LOAD_SCENARIO,   ///< Load scenario from scenario editor.
 	SM_START_HEIGHTMAP, ///< Load a heightmap and start a new game from it.
 	SM_LOAD_HEIGHTMAP,  ///< Load heightmap from scenario editor.
+	SM_REPLAY,          ///< Replay a command recording.
 };
 
 /** Display Options */
@@ -20,6 +20,8 @@
 #include "station_type.h"
 #include "vehicle_type.h"
 #include "date_type.h"
+#include <map>
+#include <vector>
 
 typedef Pool<Order, OrderID, 256, 0xFF0000> OrderPool;
 typedef Pool<OrderList, OrderListID, 128, 64000> OrderListPool;
@@ -245,6 +247,12 @@ public:
 void InsertOrder(Vehicle *v, Order *new_o, VehicleOrderID sel_ord);
 void DeleteOrder(Vehicle *v, VehicleOrderID sel_ord);
 
+/**
+ * Links the LinkRefresher predicted for an order list, as pairs of the order
+ * the consist leaves with cargo and the next order where it stops.
+ */
+typedef std::vector<std::pair<const Order *, const Order *> > LinkRefreshPrediction;
+
 /**
  * Shared order list linking together the linked list of orders and the list
  *  of vehicles sharing this order list.
@@ -265,6 +273,9 @@ private:
 	Ticks timetable_duration;         ///< NOSAVE: Total timetabled duration of the order list.
 	Ticks total_duration;             ///< NOSAVE: Total (timetabled or not) duration of the order list.
 
+	/** NOSAVE: Link refresh predictions for consists not refitting on the way, by first order and refresh flags. */
+	std::map<std::pair<const Order *, uint8>, LinkRefreshPrediction> link_predictions;
+
 public:
 	/** Default constructor producing an invalid order list. */
 	OrderList(VehicleOrderID num_orders = INVALID_VEH_ORDER_ID)
@@ -389,6 +400,32 @@ public:
 
 	void FreeChain(bool keep_orderlist = false);
 
+	/**
+	 * Get the cached link refresh prediction for a consist starting at the given order.
+	 * @param first First order the prediction starts at.
+	 * @param flags Refresh flags the prediction was started with.
+	 * @return The prediction or nullptr if there is none.
+	 */
+	inline const LinkRefreshPrediction *GetLinkRefreshPrediction(const Order *first, uint8 flags) const
+	{
+		std::map<std::pair<const Order *, uint8>, LinkRefreshPrediction>::const_iterator it = this->link_predictions.find(std::make_pair(first, flags));
+		return it == this->link_predictions.end() ? nullptr : &it->second;
+	}
+
+	/**
+	 * Cache a link refresh prediction for consists starting at the given order.
+	 * @param first First order the prediction starts at.
+	 * @param flags Refresh flags the prediction was started with.
+	 * @param prediction The predicted links.
+	 */
+	inline void SetLinkRefreshPrediction(const Order *first, uint8 flags, const LinkRefreshPrediction &prediction)
+	{
+		this->link_predictions[std::make_pair(first, flags)] = prediction;
+	}
+
+	/** Drop the cached link refresh predictions. Must be called whenever any order in the list changes. */
+	inline void InvalidateLinkRefreshPredictions() { this->link_predictions.clear(); }
+
 	void DebugCheckSanity() const;
 };
 
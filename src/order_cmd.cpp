@@ -299,6 +299,7 @@ void OrderList::Initialize(Order *chain, Vehicle *v)
 	this->num_vehicles = 1;
 	this->timetable_duration = 0;
 	this->total_duration = 0;
+	this->InvalidateLinkRefreshPredictions();
 
 	for (Order *o = this->first; o != nullptr; o = o->next) {
 		++this->num_orders;
@@ -322,6 +323,8 @@ void OrderList::Initialize(Order *chain, Vehicle *v)
  */
 void OrderList::FreeChain(bool keep_orderlist)
 {
+	this->InvalidateLinkRefreshPredictions();
+
 	Order *next;
 	for (Order *o = this->first; o != nullptr; o = next) {
 		next = o->next;
@@ -460,6 +463,8 @@ StationIDStack OrderList::GetNextStoppingStation(const Vehicle *v, const Order *
  */
 void OrderList::InsertOrderAt(Order *new_order, int index)
 {
+	this->InvalidateLinkRefreshPredictions();
+
 	if (this->first == nullptr) {
 		this->first = new_order;
 	} else {
@@ -500,6 +505,8 @@ void OrderList::DeleteOrderAt(int index)
 {
 	if (index >= this->num_orders) return;
 
+	this->InvalidateLinkRefreshPredictions();
+
 	Order *to_remove;
 
 	if (index == 0) {
@@ -526,6 +533,8 @@ void OrderList::MoveOrder(int from, int to)
 {
 	if (from >= this->num_orders || to >= this->num_orders || from == to) return;
 
+	this->InvalidateLinkRefreshPredictions();
+
 	Order *moving_one;
 
 	/* Take the moving order out of the pointer-chain */
@@ -1456,6 +1465,8 @@ CommandCost CmdModifyOrder(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 			default: NOT_REACHED();
 		}
 
+		v->orders.list->InvalidateLinkRefreshPredictions();
+
 		/* Update the windows and full load flags, also for vehicles that share the same order list */
 		Vehicle *u = v->FirstShared();
 		DeleteOrderWarnings(u);
@@ -1696,6 +1707,7 @@ CommandCost CmdOrderRefit(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 	if (flags & DC_EXEC) {
 		order->SetRefit(cargo);
+		v->orders.list->InvalidateLinkRefreshPredictions();
 
 		/* Make the depot order an 'always go' order. */
 		if (cargo != CT_NO_REFIT && order->IsType(OT_GOTO_DEPOT)) {
@@ -1852,6 +1864,7 @@ restart:
 				bool travel_timetabled = order->IsTravelTimetabled();
 				order->MakeDummy();
 				order->SetTravelTimetabled(travel_timetabled);
+				v->orders.list->InvalidateLinkRefreshPredictions();
 
 				for (const Vehicle *w = v->FirstShared(); w != nullptr; w = w->NextShared()) {
 					/* In GUI, simulate by removing the order and adding it back */
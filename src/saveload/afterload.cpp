@@ -58,11 +58,15 @@
 #include "../disaster_vehicle.h"
 #include "../ship.h"
 #include "../water.h"
+#include "../thread.h"
 
 
 #include "saveload_internal.h"
 
 #include <signal.h>
+#include <chrono>
+#include <initializer_list>
+#include <vector>
 
 #include "../safeguards.h"
 
@@ -309,6 +313,55 @@ static void InitializeWindowsAndCaches()
 	BuildOwnerLegend();
 }
 
+extern const SaveLoadVersion SAVEGAME_VERSION;
+
+/** Reports how long the phases of AfterLoadGame take in the debug output. */
+struct AfterLoadPhaseTimer {
+	std::chrono::steady_clock::time_point start; ///< Start of AfterLoadGame.
+	std::chrono::steady_clock::time_point phase; ///< Start of the current phase.
+
+	AfterLoadPhaseTimer() : start(std::chrono::steady_clock::now()), phase(start) {}
+
+	/**
+	 * The current phase has ended; report how long it took.
+	 * @param name Description of the phase.
+	 */
+	void EndPhase(const char *name)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		DEBUG(sl, 2, "AfterLoadGame: %s took %d ms", name, (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - this->phase).count());
+		this->phase = now;
+	}
+
+	/** Report how long everything took. */
+	void End()
+	{
+		this->EndPhase("the last phase");
+		DEBUG(sl, 1, "AfterLoadGame took %d ms", (int)std::chrono::duration_cast<std::chrono::milliseconds>(this->phase - this->start).count());
+	}
+};
+
+/**
+ * Rebuild caches that are independent of each other. For savegames of the current version they are rebuilt
+ * at the same time. Older savegames are converted in between, so there they are rebuilt one after another.
+ * @param procs The rebuilds; none of them may change anything another one of them reads.
+ */
+static void RebuildIndependentCaches(std::initializer_list<void (*)()> procs)
+{
+	std::vector<std::thread> threads;
+	auto proc = procs.begin();
+	if (!IsSavegameVersionBefore(SAVEGAME_VERSION)) {
+		for (; proc != procs.end() - 1; proc++) {
+			std::thread t;
+			void (*rebuild)() = *proc;
+			if (!StartNewThread(&t, "ottd:afterload", [rebuild]() { rebuild(); })) break;
+			threads.push_back(std::move(t));
+		}
+	}
+	for (; proc != procs.end(); proc++) (*proc)();
+	for (std::thread &t : threads) t.join();
+}
+
 typedef void (CDECL *SignalHandlerPointer)(int);
 static SignalHandlerPointer _prev_segfault = nullptr;
 static SignalHandlerPointer _prev_abort    = nullptr;
@@ -544,6 +597,7 @@ static inline bool MayHaveBridgeAbove(TileIndex t)
 bool AfterLoadGame()
 {
 	SetSignalHandlers();
+	AfterLoadPhaseTimer timer;
 
 	TileIndex map_size = MapSize();
 
@@ -556,11 +610,10 @@ bool AfterLoadGame()
 	GamelogTestRevision();
 	GamelogTestMode();
 
-	RebuildTownKdtree();
-	RebuildStationKdtree();
-	/* This needs to be done even before conversion, because some conversions will destroy objects
-	 * that otherwise won't exist in the tree. */
-	RebuildViewportKdtree();
+	/* The viewport kd-tree needs to be built even before conversion, because some conversions will
+	 * destroy objects that otherwise won't exist in the tree. */
+	RebuildIndependentCaches({ RebuildTownKdtree, RebuildStationKdtree, RebuildViewportKdtree });
+	timer.EndPhase("rebuilding the kd-trees");
 
 	if (IsSavegameVersionBefore(SLV_98)) GamelogGRFAddList(_grfconfig);
 
@@ -799,6 +852,7 @@ bool AfterLoadGame()
 
 	/* Update all vehicles */
 	AfterLoadVehicles(true);
+	timer.EndPhase("updating vehicles");
 
 	/* Make sure there is an AI attached to an AI company */
 	{
@@ -1426,6 +1480,7 @@ bool AfterLoadGame()
 	}
 
 	if (!IsSavegameVersionBefore(SLV_27)) AfterLoadStations();
+	timer.EndPhase("updating stations");
 
 	/* Time starts at 0 instead of 1920.
 	 * Account for this in older games by adding an offset */
@@ -1532,6 +1587,7 @@ bool AfterLoadGame()
 
 	/* Check and update house and town values */
 	UpdateHousesAndTowns();
+	timer.EndPhase("updating houses and towns");
 
 	if (IsSavegameVersionBefore(SLV_43)) {
 		for (TileIndex t = 0; t < map_size; t++) {
@@ -3198,8 +3254,14 @@ bool AfterLoadGame()
 		}
 	}
 
-	/* Compute station catchment areas. This is needed here in case UpdateStationAcceptance is called below. */
-	Station::RecomputeCatchmentForAll();
+	timer.EndPhase("converting the map and pools");
+
+	/* The label maps change the rail types on the map, which the company statistics count. */
+	AfterLoadLabelMaps();
+
+	/* Compute station catchment areas. This is needed here in case UpdateStationAcceptance is called below.
+	 * Road stops is 'only' updating some caches. */
+	RebuildIndependentCaches({ Station::RecomputeCatchmentForAll, AfterLoadRoadStops, AfterLoadCompanyStats });
 
 	/* Station acceptance is some kind of cache */
 	if (IsSavegameVersionBefore(SLV_127)) {
@@ -3207,19 +3269,18 @@ bool AfterLoadGame()
 		FOR_ALL_STATIONS(st) UpdateStationAcceptance(st, false);
 	}
 
-	/* Road stops is 'only' updating some caches */
-	AfterLoadRoadStops();
-	AfterLoadLabelMaps();
-	AfterLoadCompanyStats();
 	AfterLoadStoryBook();
+	timer.EndPhase("rebuilding station, road stop and company caches");
 
 	GamelogPrintDebug(1);
 
 	InitializeWindowsAndCaches();
+	timer.EndPhase("initialising windows and caches");
 	/* Restore the signals */
 	ResetSignalHandlers();
 
 	AfterLoadLinkGraphs();
+	timer.End();
 	return true;
 }
 
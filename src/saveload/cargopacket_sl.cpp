@@ -116,6 +116,10 @@ const SaveLoad *GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
+	/* The packets in vehicles might not have been aged yet. */
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) v->cargo.ApplyPendingAging();
+
 	CargoPacket *cp;
 
 	FOR_ALL_CARGOPACKETS(cp) {
@@ -16,6 +16,7 @@
 #include <array>
 
 #include "saveload.h"
+#include "saveload_internal.h"
 
 #include "../safeguards.h"
 
@@ -50,263 +51,151 @@ static void Check_MAPS()
 
 static const uint MAP_SL_BUF_SIZE = 4096;
 
-static void Load_MAPT()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].type = buf[j];
-	}
-}
-
-static void Save_MAPT()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].type;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
-
-static void Load_MAPH()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].height = buf[j];
-	}
-}
-
-static void Save_MAPH()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].height;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
-
-static void Load_MAP1()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
+/** The map that is being saved; either the map itself or a copy of it. */
+struct MapSaveSource {
+	Tile *m;          ///< The tiles to save.
+	TileExtended *me; ///< The extended tile data to save.
+	TileIndex size;   ///< The number of tiles to save.
+	bool snapshot;    ///< Whether #m and #me are a copy, owned by us.
+};
 
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m1 = buf[j];
-	}
-}
+static MapSaveSource _map_save_source; ///< The map to save the map chunks from.
 
-static void Save_MAP1()
+/**
+ * Set the map the map chunks are saved from.
+ * @param snapshot Whether to save from a copy of the current map, so the map
+ *                 chunks can be saved while the game modifies the map.
+ */
+void SetMapSaveSource(bool snapshot)
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
+	FreeMapSaveSource();
 
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m1;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
+	_map_save_source.size = MapSize();
+	_map_save_source.snapshot = snapshot;
+	if (snapshot) {
+		_map_save_source.m = MallocT<Tile>(MapSize());
+		_map_save_source.me = MallocT<TileExtended>(MapSize());
+		MemCpyT(_map_save_source.m, _m, MapSize());
+		MemCpyT(_map_save_source.me, _me, MapSize());
+	} else {
+		_map_save_source.m = _m;
+		_map_save_source.me = _me;
 	}
 }
 
-static void Load_MAP2()
+/** Free the copy of the map made by #SetMapSaveSource, if any. */
+void FreeMapSaveSource()
 {
-	std::array<uint16, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE,
-			/* In those versions the m2 was 8 bits */
-			IsSavegameVersionBefore(SLV_5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
-		);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m2 = buf[j];
+	if (_map_save_source.snapshot) {
+		free(_map_save_source.m);
+		free(_map_save_source.me);
 	}
+	_map_save_source = {};
 }
 
-static void Save_MAP2()
+/**
+ * Load a map chunk, which holds one field of every tile, into that field of the tiles.
+ * The chunk is converted in parts of #MAP_SL_BUF_SIZE tiles, so no copy of the whole chunk is needed.
+ * @param tiles The tiles to load into; either #_m or #_me.
+ * @param field The field of the tiles to load.
+ * @param conv  The type of the field in the savegame.
+ */
+template <typename T, typename V>
+static void LoadMapField(T *tiles, V T::*field, VarType conv)
 {
-	std::array<uint16, MAP_SL_BUF_SIZE> buf;
+	std::array<V, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
-	SlSetLength(size * sizeof(uint16));
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m2;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-	}
-}
-
-static void Load_MAP3()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
+	for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+		SlArray(buf.data(), MAP_SL_BUF_SIZE, conv);
 
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m3 = buf[j];
+		T *t = tiles + i;
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) t[j].*field = buf[j];
 	}
 }
 
-static void Save_MAP3()
+/**
+ * Save one field of every tile of the map save source as a map chunk.
+ * The chunk is converted in parts of #MAP_SL_BUF_SIZE tiles, so no copy of the whole chunk is needed.
+ * @param tiles The tiles to save from; either #MapSaveSource::m or #MapSaveSource::me.
+ * @param field The field of the tiles to save.
+ * @param conv  The type of the field in the savegame.
+ */
+template <typename T, typename V>
+static void SaveMapField(const T *tiles, V T::*field, VarType conv)
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m3;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
+	std::array<V, MAP_SL_BUF_SIZE> buf;
+	TileIndex size = _map_save_source.size;
 
-static void Load_MAP4()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
+	SlSetLength(size * sizeof(V));
+	for (TileIndex i = 0; i != size; i += MAP_SL_BUF_SIZE) {
+		const T *t = tiles + i;
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = t[j].*field;
 
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m4 = buf[j];
+		SlArray(buf.data(), MAP_SL_BUF_SIZE, conv);
 	}
 }
 
-static void Save_MAP4()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m4;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
+static void Load_MAPT() { LoadMapField(_m, &Tile::type, SLE_UINT8); }
+static void Save_MAPT() { SaveMapField(_map_save_source.m, &Tile::type, SLE_UINT8); }
+static void Load_MAPH() { LoadMapField(_m, &Tile::height, SLE_UINT8); }
+static void Save_MAPH() { SaveMapField(_map_save_source.m, &Tile::height, SLE_UINT8); }
+static void Load_MAP1() { LoadMapField(_m, &Tile::m1, SLE_UINT8); }
+static void Save_MAP1() { SaveMapField(_map_save_source.m, &Tile::m1, SLE_UINT8); }
 
-static void Load_MAP5()
+static void Load_MAP2()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m5 = buf[j];
-	}
+	/* In those versions the m2 was 8 bits */
+	LoadMapField(_m, &Tile::m2, IsSavegameVersionBefore(SLV_5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16);
 }
 
-static void Save_MAP5()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].m5;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
+static void Save_MAP2() { SaveMapField(_map_save_source.m, &Tile::m2, SLE_UINT16); }
+static void Load_MAP3() { LoadMapField(_m, &Tile::m3, SLE_UINT8); }
+static void Save_MAP3() { SaveMapField(_map_save_source.m, &Tile::m3, SLE_UINT8); }
+static void Load_MAP4() { LoadMapField(_m, &Tile::m4, SLE_UINT8); }
+static void Save_MAP4() { SaveMapField(_map_save_source.m, &Tile::m4, SLE_UINT8); }
+static void Load_MAP5() { LoadMapField(_m, &Tile::m5, SLE_UINT8); }
+static void Save_MAP5() { SaveMapField(_map_save_source.m, &Tile::m5, SLE_UINT8); }
 
 static void Load_MAP6()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	if (IsSavegameVersionBefore(SLV_42)) {
-		for (TileIndex i = 0; i != size;) {
-			/* 1024, otherwise we overflow on 64x64 maps! */
-			SlArray(buf.data(), 1024, SLE_UINT8);
-			for (uint j = 0; j != 1024; j++) {
-				_me[i++].m6 = GB(buf[j], 0, 2);
-				_me[i++].m6 = GB(buf[j], 2, 2);
-				_me[i++].m6 = GB(buf[j], 4, 2);
-				_me[i++].m6 = GB(buf[j], 6, 2);
-			}
-		}
-	} else {
-		for (TileIndex i = 0; i != size;) {
-			SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m6 = buf[j];
-		}
+	if (!IsSavegameVersionBefore(SLV_42)) {
+		LoadMapField(_me, &TileExtended::m6, SLE_UINT8);
+		return;
 	}
-}
 
-static void Save_MAP6()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _me[i++].m6;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
-
-static void Load_MAP7()
-{
 	std::array<byte, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m7 = buf[j];
-	}
-}
-
-static void Save_MAP7()
-{
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size);
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _me[i++].m7;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-	}
-}
-
-static void Load_MAP8()
-{
-	std::array<uint16, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m8 = buf[j];
+		/* 1024, otherwise we overflow on 64x64 maps! */
+		SlArray(buf.data(), 1024, SLE_UINT8);
+		for (uint j = 0; j != 1024; j++) {
+			_me[i++].m6 = GB(buf[j], 0, 2);
+			_me[i++].m6 = GB(buf[j], 2, 2);
+			_me[i++].m6 = GB(buf[j], 4, 2);
+			_me[i++].m6 = GB(buf[j], 6, 2);
+		}
 	}
 }
 
-static void Save_MAP8()
-{
-	std::array<uint16, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	SlSetLength(size * sizeof(uint16));
-	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _me[i++].m8;
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-	}
-}
+static void Save_MAP6() { SaveMapField(_map_save_source.me, &TileExtended::m6, SLE_UINT8); }
+static void Load_MAP7() { LoadMapField(_me, &TileExtended::m7, SLE_UINT8); }
+static void Save_MAP7() { SaveMapField(_map_save_source.me, &TileExtended::m7, SLE_UINT8); }
+static void Load_MAP8() { LoadMapField(_me, &TileExtended::m8, SLE_UINT16); }
+static void Save_MAP8() { SaveMapField(_map_save_source.me, &TileExtended::m8, SLE_UINT16); }
 
 
 extern const ChunkHandler _map_chunk_handlers[] = {
 	{ 'MAPS', Save_MAPS, Load_MAPS, nullptr, Check_MAPS, CH_RIFF },
-	{ 'MAPT', Save_MAPT, Load_MAPT, nullptr, nullptr,    CH_RIFF },
-	{ 'MAPH', Save_MAPH, Load_MAPH, nullptr, nullptr,    CH_RIFF },
-	{ 'MAPO', Save_MAP1, Load_MAP1, nullptr, nullptr,    CH_RIFF },
-	{ 'MAP2', Save_MAP2, Load_MAP2, nullptr, nullptr,    CH_RIFF },
-	{ 'M3LO', Save_MAP3, Load_MAP3, nullptr, nullptr,    CH_RIFF },
-	{ 'M3HI', Save_MAP4, Load_MAP4, nullptr, nullptr,    CH_RIFF },
-	{ 'MAP5', Save_MAP5, Load_MAP5, nullptr, nullptr,    CH_RIFF },
-	{ 'MAPE', Save_MAP6, Load_MAP6, nullptr, nullptr,    CH_RIFF },
-	{ 'MAP7', Save_MAP7, Load_MAP7, nullptr, nullptr,    CH_RIFF },
-	{ 'MAP8', Save_MAP8, Load_MAP8, nullptr, nullptr,    CH_RIFF | CH_LAST },
+	{ 'MAPT', Save_MAPT, Load_MAPT, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAPH', Save_MAPH, Load_MAPH, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAPO', Save_MAP1, Load_MAP1, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAP2', Save_MAP2, Load_MAP2, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'M3LO', Save_MAP3, Load_MAP3, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'M3HI', Save_MAP4, Load_MAP4, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAP5', Save_MAP5, Load_MAP5, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAPE', Save_MAP6, Load_MAP6, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAP7', Save_MAP7, Load_MAP7, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT },
+	{ 'MAP8', Save_MAP8, Load_MAP8, nullptr, nullptr,    CH_RIFF | CH_SNAPSHOT | CH_LAST },
 };
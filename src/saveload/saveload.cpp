@@ -42,16 +42,32 @@
 #include "../statusbar_gui.h"
 #include "../fileio_func.h"
 #include "../gamelog.h"
+#include "../gamelog_internal.h"
 #include "../string_func.h"
 #include "../fios.h"
 #include "../error.h"
+#include "../3rdparty/md5/md5.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "table/strings.h"
 
 #include "saveload_internal.h"
 #include "saveload_filter.h"
 
+#if defined(UNIX)
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
 #include "../safeguards.h"
 
 extern const SaveLoadVersion SAVEGAME_VERSION = (SaveLoadVersion)(SL_MAX_VERSION - 1); ///< Current savegame version of OpenTTD.
@@ -86,8 +102,8 @@ static const size_t MEMORY_CHUNK_SIZE = 128 * 1024;
 /** A buffer for reading (and buffering) savegame data. */
 struct ReadBuffer {
 	byte buf[MEMORY_CHUNK_SIZE]; ///< Buffer we're going to read from.
-	byte *bufp;                  ///< Location we're at reading the buffer.
-	byte *bufe;                  ///< End of the buffer we can read from.
+	const byte *bufp;            ///< Location we're at reading the buffer.
+	const byte *bufe;            ///< End of the buffer we can read from; either in #buf or in the data of the filter.
 	LoadFilter *reader;          ///< The filter used to actually read.
 	size_t read;                 ///< The amount of read bytes so far from the filter.
 
@@ -99,20 +115,47 @@ struct ReadBuffer {
 	{
 	}
 
-	inline byte ReadByte()
+	/** Refill the buffer from the filter, or read straight from the data of the filter when it allows that. */
+	void FillBuffer()
 	{
-		if (this->bufp == this->bufe) {
-			size_t len = this->reader->Read(this->buf, lengthof(this->buf));
-			if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
-
-			this->read += len;
-			this->bufp = this->buf;
-			this->bufe = this->buf + len;
+		size_t len;
+		const byte *direct = this->reader->ReadDirect(&len);
+		if (direct == nullptr) {
+			len = this->reader->Read(this->buf, lengthof(this->buf));
+			direct = this->buf;
 		}
+		if (len == 0) SlErrorCorrupt("Unexpected end of chunk");
+
+		this->read += len;
+		this->bufp = direct;
+		this->bufe = direct + len;
+	}
+
+	inline byte ReadByte()
+	{
+		if (this->bufp == this->bufe) this->FillBuffer();
 
 		return *this->bufp++;
 	}
 
+	/**
+	 * Read a number of bytes at once.
+	 * @param ptr    The memory to read the bytes into.
+	 * @param length The number of bytes to read.
+	 */
+	void CopyBytes(byte *ptr, size_t length)
+	{
+		while (length > 0) {
+			if (this->bufp == this->bufe) this->FillBuffer();
+
+			size_t to_copy = min<size_t>(this->bufe - this->bufp, length);
+			memcpy(ptr, this->bufp, to_copy);
+			this->bufp += to_copy;
+			ptr += to_copy;
+			length -= to_copy;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -149,15 +192,37 @@ struct MemoryDumper {
 	inline void WriteByte(byte b)
 	{
 		/* Are we at the end of this chunk? */
-		if (this->buf == this->bufe) {
-			this->buf = CallocT<byte>(MEMORY_CHUNK_SIZE);
-			this->blocks.push_back(this->buf);
-			this->bufe = this->buf + MEMORY_CHUNK_SIZE;
-		}
+		if (this->buf == this->bufe) this->AllocateBlock();
 
 		*this->buf++ = b;
 	}
 
+	/**
+	 * Write a number of bytes at once.
+	 * @param ptr    The bytes to write.
+	 * @param length The number of bytes to write.
+	 */
+	void CopyBytes(const byte *ptr, size_t length)
+	{
+		while (length > 0) {
+			if (this->buf == this->bufe) this->AllocateBlock();
+
+			size_t to_copy = min<size_t>(this->bufe - this->buf, length);
+			memcpy(this->buf, ptr, to_copy);
+			this->buf += to_copy;
+			ptr += to_copy;
+			length -= to_copy;
+		}
+	}
+
+	/** Start writing into a new block of memory. */
+	void AllocateBlock()
+	{
+		this->buf = CallocT<byte>(MEMORY_CHUNK_SIZE);
+		this->blocks.push_back(this->buf);
+		this->bufe = this->buf + MEMORY_CHUNK_SIZE;
+	}
+
 	/**
 	 * Flush this dumper into a writer.
 	 * @param writer The filter we want to use.
@@ -173,8 +238,6 @@ struct MemoryDumper {
 			writer->Write(this->blocks[i++], to_write);
 			t -= to_write;
 		}
-
-		writer->Finish();
 	}
 
 	/**
@@ -187,17 +250,33 @@ struct MemoryDumper {
 	}
 };
 
+/**
+ * A consecutive part of the savegame in memory. Chunks flagged with #CH_SNAPSHOT
+ * get a segment of their own, that is only filled when the game has been resumed.
+ */
+struct SaveSegment {
+	MemoryDumper *dumper;   ///< The data of this segment; \c nullptr when it still has to be saved.
+	const ChunkHandler *ch; ///< The chunk to save into this segment later on, or \c nullptr.
+	int save_time;          ///< The time it took to save the chunk, in milliseconds.
+};
+
+/** Size and save time of a chunk, to be logged once the savegame has been written. */
+struct SavedChunkInfo {
+	const ChunkHandler *ch; ///< The saved chunk.
+	size_t size;            ///< The size of the saved chunk, in bytes.
+	int save_time;          ///< The time it took to save the chunk, in milliseconds.
+};
+
 /** The saveload struct, containing reader-writer functions, buffer, version, etc. */
 struct SaveLoadParams {
 	SaveLoadAction action;               ///< are we doing a save or a load atm.
-	NeedLength need_length;              ///< working in NeedLength (Autolength) mode?
-	byte block_mode;                     ///< ???
 	bool error;                          ///< did an error occur or not
 
-	size_t obj_len;                      ///< the length of the current object we are busy with
-	int array_index, last_array_index;   ///< in the case of an array, the current and last positions
-
-	MemoryDumper *dumper;                ///< Memory dumper to write the savegame to.
+	std::vector<SaveSegment> segments;   ///< All parts of the savegame in memory, in the order they are written.
+	std::vector<byte> summary;           ///< Uncompressed summary of the savegame, written in front of the compressed data.
+	SaveDeltaMode delta_mode;            ///< Whether the savegame is complete, or only contains the differences with the last checkpoint.
+	std::string delta_name;              ///< Name of the savegame being written, without directory, for delta savegames to refer to.
+	std::vector<SavedChunkInfo> saved_chunks; ///< Chunks saved by the save thread; they are logged by the main thread when saving is done.
 	SaveFilter *sf;                      ///< Filter to write the savegame to.
 
 	ReadBuffer *reader;                  ///< Savegame reading buffer.
@@ -212,6 +291,24 @@ struct SaveLoadParams {
 
 static SaveLoadParams _sl; ///< Parameters used for/at saveload.
 
+/**
+ * The state of the chunk that is being saved or loaded. Chunks that are
+ * saved from a snapshot may be saved on several threads at the same time,
+ * so every thread has its own state.
+ */
+struct SaveLoadChunkState {
+	NeedLength need_length;              ///< working in NeedLength (Autolength) mode?
+	byte block_mode;                     ///< ???
+
+	size_t obj_len;                      ///< the length of the current object we are busy with
+	int array_index, last_array_index;   ///< in the case of an array, the current and last positions
+
+	MemoryDumper *dumper;                ///< Memory dumper to write the savegame to.
+};
+
+static thread_local SaveLoadChunkState _sl_chunk; ///< State of the chunk being saved or loaded by this thread.
+static thread_local bool _sl_read_ahead_thread = false; ///< Whether this thread reads the savegame ahead of the main thread; see #ReadAheadLoadFilter.
+
 /* these define the chunks */
 extern const ChunkHandler _gamelog_chunk_handlers[];
 extern const ChunkHandler _map_chunk_handlers[];
@@ -327,6 +424,10 @@ static void SlNullPointers()
  */
 void NORETURN SlError(StringID string, const char *extra_msg)
 {
+	/* Chunks may be saved by several threads at once. */
+	static std::mutex error_lock;
+	std::lock_guard<std::mutex> lock(error_lock);
+
 	/* Distinguish between loading into _load_check_data vs. normal save/load. */
 	if (_sl.action == SLA_LOAD_CHECK) {
 		_load_check_data.error = string;
@@ -342,7 +443,7 @@ void NORETURN SlError(StringID string, const char *extra_msg)
 	 * the pointers are actually filled with indices, which means that
 	 * when we access them during cleaning the pool dereferences of
 	 * those indices will be made with segmentation faults as result. */
-	if (_sl.action == SLA_LOAD || _sl.action == SLA_PTRS) SlNullPointers();
+	if ((_sl.action == SLA_LOAD || _sl.action == SLA_PTRS) && !_sl_read_ahead_thread) SlNullPointers();
 	throw std::exception();
 }
 
@@ -424,7 +525,7 @@ byte SlReadByte()
  */
 void SlWriteByte(byte b)
 {
-	_sl.dumper->WriteByte(b);
+	_sl_chunk.dumper->WriteByte(b);
 }
 
 static inline int SlReadUint16()
@@ -626,8 +727,8 @@ static inline size_t SlCalcRefLen()
 
 void SlSetArrayIndex(uint index)
 {
-	_sl.need_length = NL_WANTLENGTH;
-	_sl.array_index = index;
+	_sl_chunk.need_length = NL_WANTLENGTH;
+	_sl_chunk.array_index = index;
 }
 
 static size_t _next_offs;
@@ -651,12 +752,12 @@ int SlIterateArray()
 			return -1;
 		}
 
-		_sl.obj_len = --length;
+		_sl_chunk.obj_len = --length;
 		_next_offs = _sl.reader->GetSize() + length;
 
-		switch (_sl.block_mode) {
+		switch (_sl_chunk.block_mode) {
 			case CH_SPARSE_ARRAY: index = (int)SlReadSparseIndex(); break;
-			case CH_ARRAY:        index = _sl.array_index++; break;
+			case CH_ARRAY:        index = _sl_chunk.array_index++; break;
 			default:
 				DEBUG(sl, 0, "SlIterateArray error");
 				return -1; // error
@@ -685,10 +786,10 @@ void SlSetLength(size_t length)
 {
 	assert(_sl.action == SLA_SAVE);
 
-	switch (_sl.need_length) {
+	switch (_sl_chunk.need_length) {
 		case NL_WANTLENGTH:
-			_sl.need_length = NL_NONE;
-			switch (_sl.block_mode) {
+			_sl_chunk.need_length = NL_NONE;
+			switch (_sl_chunk.block_mode) {
 				case CH_RIFF:
 					/* Ugly encoding of >16M RIFF chunks
 					 * The lower 24 bits are normal
@@ -697,22 +798,22 @@ void SlSetLength(size_t length)
 					SlWriteUint32((uint32)((length & 0xFFFFFF) | ((length >> 24) << 28)));
 					break;
 				case CH_ARRAY:
-					assert(_sl.last_array_index <= _sl.array_index);
-					while (++_sl.last_array_index <= _sl.array_index) {
+					assert(_sl_chunk.last_array_index <= _sl_chunk.array_index);
+					while (++_sl_chunk.last_array_index <= _sl_chunk.array_index) {
 						SlWriteArrayLength(1);
 					}
 					SlWriteArrayLength(length + 1);
 					break;
 				case CH_SPARSE_ARRAY:
-					SlWriteArrayLength(length + 1 + SlGetArrayLength(_sl.array_index)); // Also include length of sparse index.
-					SlWriteSparseIndex(_sl.array_index);
+					SlWriteArrayLength(length + 1 + SlGetArrayLength(_sl_chunk.array_index)); // Also include length of sparse index.
+					SlWriteSparseIndex(_sl_chunk.array_index);
 					break;
 				default: NOT_REACHED();
 			}
 			break;
 
 		case NL_CALCLENGTH:
-			_sl.obj_len += (int)length;
+			_sl_chunk.obj_len += (int)length;
 			break;
 
 		default: NOT_REACHED();
@@ -732,11 +833,60 @@ static void SlCopyBytes(void *ptr, size_t length)
 	switch (_sl.action) {
 		case SLA_LOAD_CHECK:
 		case SLA_LOAD:
-			for (; length != 0; length--) *p++ = SlReadByte();
+			_sl.reader->CopyBytes(p, length);
 			break;
 		case SLA_SAVE:
-			for (; length != 0; length--) SlWriteByte(*p++);
+			_sl_chunk.dumper->CopyBytes(p, length);
+			break;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Save/Load an array of 16 or 32 bits integers that have the same size in memory
+ * and in the savegame. The savegame stores them in big endian, so only the byte
+ * order has to be converted, which is done in bulk instead of per element.
+ * @param ptr    The array to save/load.
+ * @param length The number of elements in the array.
+ * @param size   The size of an element; 2 or 4.
+ */
+static void SlCopyBigEndian(void *ptr, size_t length, size_t size)
+{
+	assert(size == 2 || size == 4);
+
+	switch (_sl.action) {
+		case SLA_LOAD_CHECK:
+		case SLA_LOAD:
+			SlCopyBytes(ptr, length * size);
+			if (size == 2) {
+				uint16 *p = (uint16 *)ptr;
+				for (size_t i = 0; i != length; i++) p[i] = FROM_BE16(p[i]);
+			} else {
+				uint32 *p = (uint32 *)ptr;
+				for (size_t i = 0; i != length; i++) p[i] = FROM_BE32(p[i]);
+			}
+			break;
+
+		case SLA_SAVE: {
+			/* Convert in pieces, as the array itself must not be changed. */
+			uint32 buf[1024];
+			while (length != 0) {
+				size_t n = min<size_t>(length, sizeof(buf) / size);
+				if (size == 2) {
+					const uint16 *p = (const uint16 *)ptr;
+					uint16 *b = (uint16 *)buf;
+					for (size_t i = 0; i != n; i++) b[i] = TO_BE16(p[i]);
+				} else {
+					const uint32 *p = (const uint32 *)ptr;
+					for (size_t i = 0; i != n; i++) buf[i] = TO_BE32(p[i]);
+				}
+				SlCopyBytes(buf, n * size);
+				ptr = (byte *)ptr + n * size;
+				length -= n;
+			}
 			break;
+		}
+
 		default: NOT_REACHED();
 	}
 }
@@ -744,7 +894,7 @@ static void SlCopyBytes(void *ptr, size_t length)
 /** Get the length of the current object */
 size_t SlGetFieldLength()
 {
-	return _sl.obj_len;
+	return _sl_chunk.obj_len;
 }
 
 /**
@@ -999,10 +1149,10 @@ void SlArray(void *array, size_t length, VarType conv)
 	if (_sl.action == SLA_PTRS || _sl.action == SLA_NULL) return;
 
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_sl_chunk.need_length != NL_NONE) {
 		SlSetLength(SlCalcArrayLen(length, conv));
 		/* Determine length only? */
-		if (_sl.need_length == NL_CALCLENGTH) return;
+		if (_sl_chunk.need_length == NL_CALCLENGTH) return;
 	}
 
 	/* NOTICE - handle some buggy stuff, in really old versions everything was saved
@@ -1027,6 +1177,9 @@ void SlArray(void *array, size_t length, VarType conv)
 	 * conversion is needed, use specialized copy-copy function to speed up things */
 	if (conv == SLE_INT8 || conv == SLE_UINT8) {
 		SlCopyBytes(array, length);
+	} else if (conv == SLE_INT16 || conv == SLE_UINT16 || conv == SLE_INT32 || conv == SLE_UINT32) {
+		/* Same size in file and memory, so only the byte order has to be converted. */
+		SlCopyBigEndian(array, length, SlCalcConvMemLen(conv));
 	} else {
 		byte *a = (byte*)array;
 		byte mem_size = SlCalcConvMemLen(conv);
@@ -1154,12 +1307,14 @@ static void *IntToReference(size_t index, SLRefType rt)
 }
 
 /**
- * Return the size in bytes of a list
- * @param list The std::list to find the size of
+ * Return the size in bytes of a list of references.
+ * @tparam PtrList Container type of the references (std::list or std::deque).
+ * @param list The container to find the size of.
  */
-static inline size_t SlCalcListLen(const void *list)
+template <typename PtrList>
+static inline size_t SlCalcRefListLen(const void *list)
 {
-	const std::list<void *> *l = (const std::list<void *> *) list;
+	const PtrList *l = (const PtrList *) list;
 
 	int type_size = IsSavegameVersionBefore(SLV_69) ? 2 : 4;
 	/* Each entry is saved as type_size bytes, plus type_size bytes are used for the length
@@ -1169,27 +1324,28 @@ static inline size_t SlCalcListLen(const void *list)
 
 
 /**
- * Save/Load a list.
+ * Save/Load a list of references.
+ * @tparam PtrList Container type of the references (std::list or std::deque).
  * @param list The list being manipulated
  * @param conv SLRefType type of the list (Vehicle *, Station *, etc)
  */
-static void SlList(void *list, SLRefType conv)
+template <typename PtrList>
+static void SlRefList(void *list, SLRefType conv)
 {
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
-		SlSetLength(SlCalcListLen(list));
+	if (_sl_chunk.need_length != NL_NONE) {
+		SlSetLength(SlCalcRefListLen<PtrList>(list));
 		/* Determine length only? */
-		if (_sl.need_length == NL_CALCLENGTH) return;
+		if (_sl_chunk.need_length == NL_CALCLENGTH) return;
 	}
 
-	typedef std::list<void *> PtrList;
 	PtrList *l = (PtrList *)list;
 
 	switch (_sl.action) {
 		case SLA_SAVE: {
 			SlWriteUint32((uint32)l->size());
 
-			PtrList::iterator iter;
+			typename PtrList::iterator iter;
 			for (iter = l->begin(); iter != l->end(); ++iter) {
 				void *ptr = *iter;
 				SlWriteUint32((uint32)ReferenceToInt(ptr, conv));
@@ -1208,13 +1364,10 @@ static void SlList(void *list, SLRefType conv)
 			break;
 		}
 		case SLA_PTRS: {
-			PtrList temp = *l;
-
-			l->clear();
-			PtrList::iterator iter;
-			for (iter = temp.begin(); iter != temp.end(); ++iter) {
-				void *ptr = IntToReference((size_t)*iter, conv);
-				l->push_back(ptr);
+			/* The references are resolved in place; the container keeps its shape. */
+			typename PtrList::iterator iter;
+			for (iter = l->begin(); iter != l->end(); ++iter) {
+				*iter = IntToReference((size_t)*iter, conv);
 			}
 			break;
 		}
@@ -1225,6 +1378,26 @@ static void SlList(void *list, SLRefType conv)
 	}
 }
 
+/**
+ * Save/Load a std::list of references.
+ * @param list The list being manipulated
+ * @param conv SLRefType type of the list (Vehicle *, Station *, etc)
+ */
+static inline void SlList(void *list, SLRefType conv)
+{
+	SlRefList<std::list<void *> >(list, conv);
+}
+
+/**
+ * Save/Load a std::deque of references.
+ * @param deque The deque being manipulated
+ * @param conv SLRefType type of the deque (CargoPacket *, etc)
+ */
+static inline void SlRefDeque(void *deque, SLRefType conv)
+{
+	SlRefList<std::deque<void *> >(deque, conv);
+}
+
 
 /**
  * Template class to help with std::deque.
@@ -1401,6 +1574,7 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 		case SL_STR:
 		case SL_LST:
 		case SL_DEQUE:
+		case SL_REFDEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) break;
 
@@ -1409,7 +1583,8 @@ size_t SlCalcObjMemberLength(const void *object, const SaveLoad *sld)
 				case SL_REF: return SlCalcRefLen();
 				case SL_ARR: return SlCalcArrayLen(sld->length, sld->conv);
 				case SL_STR: return SlCalcStringLen(GetVariableAddress(object, sld), sld->length, sld->conv);
-				case SL_LST: return SlCalcListLen(GetVariableAddress(object, sld));
+				case SL_LST: return SlCalcRefListLen<std::list<void *> >(GetVariableAddress(object, sld));
+				case SL_REFDEQUE: return SlCalcRefListLen<std::deque<void *> >(GetVariableAddress(object, sld));
 				case SL_DEQUE: return SlCalcDequeLen(GetVariableAddress(object, sld), sld->conv);
 				default: NOT_REACHED();
 			}
@@ -1480,6 +1655,7 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 		case SL_STR:
 		case SL_LST:
 		case SL_DEQUE:
+		case SL_REFDEQUE:
 			/* CONDITIONAL saveload types depend on the savegame version */
 			if (!SlIsObjectValidInSavegame(sld)) return false;
 			if (SlSkipVariableOnLoad(sld)) return false;
@@ -1507,6 +1683,7 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 				case SL_ARR: SlArray(ptr, sld->length, conv); break;
 				case SL_STR: SlString(ptr, sld->length, sld->conv); break;
 				case SL_LST: SlList(ptr, (SLRefType)conv); break;
+				case SL_REFDEQUE: SlRefDeque(ptr, (SLRefType)conv); break;
 				case SL_DEQUE: SlDeque(ptr, conv); break;
 				default: NOT_REACHED();
 			}
@@ -1548,9 +1725,9 @@ bool SlObjectMember(void *ptr, const SaveLoad *sld)
 void SlObject(void *object, const SaveLoad *sld)
 {
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_sl_chunk.need_length != NL_NONE) {
 		SlSetLength(SlCalcObjLength(object, sld));
-		if (_sl.need_length == NL_CALCLENGTH) return;
+		if (_sl_chunk.need_length == NL_CALCLENGTH) return;
 	}
 
 	for (; sld->cmd != SL_END; sld++) {
@@ -1580,20 +1757,20 @@ void SlAutolength(AutolengthProc *proc, void *arg)
 	assert(_sl.action == SLA_SAVE);
 
 	/* Tell it to calculate the length */
-	_sl.need_length = NL_CALCLENGTH;
-	_sl.obj_len = 0;
+	_sl_chunk.need_length = NL_CALCLENGTH;
+	_sl_chunk.obj_len = 0;
 	proc(arg);
 
 	/* Setup length */
-	_sl.need_length = NL_WANTLENGTH;
-	SlSetLength(_sl.obj_len);
+	_sl_chunk.need_length = NL_WANTLENGTH;
+	SlSetLength(_sl_chunk.obj_len);
 
-	offs = _sl.dumper->GetSize() + _sl.obj_len;
+	offs = _sl_chunk.dumper->GetSize() + _sl_chunk.obj_len;
 
 	/* And write the stuff */
 	proc(arg);
 
-	if (offs != _sl.dumper->GetSize()) SlErrorCorrupt("Invalid chunk size");
+	if (offs != _sl_chunk.dumper->GetSize()) SlErrorCorrupt("Invalid chunk size");
 }
 
 /**
@@ -1606,12 +1783,12 @@ static void SlLoadChunk(const ChunkHandler *ch)
 	size_t len;
 	size_t endoffs;
 
-	_sl.block_mode = m;
-	_sl.obj_len = 0;
+	_sl_chunk.block_mode = m;
+	_sl_chunk.obj_len = 0;
 
 	switch (m) {
 		case CH_ARRAY:
-			_sl.array_index = 0;
+			_sl_chunk.array_index = 0;
 			ch->load_proc();
 			if (_next_offs != 0) SlErrorCorrupt("Invalid array length");
 			break;
@@ -1624,7 +1801,7 @@ static void SlLoadChunk(const ChunkHandler *ch)
 				/* Read length */
 				len = (SlReadByte() << 16) | ((m >> 4) << 24);
 				len += SlReadUint16();
-				_sl.obj_len = len;
+				_sl_chunk.obj_len = len;
 				endoffs = _sl.reader->GetSize() + len;
 				ch->load_proc();
 				if (_sl.reader->GetSize() != endoffs) SlErrorCorrupt("Invalid chunk size");
@@ -1646,12 +1823,12 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
 	size_t len;
 	size_t endoffs;
 
-	_sl.block_mode = m;
-	_sl.obj_len = 0;
+	_sl_chunk.block_mode = m;
+	_sl_chunk.obj_len = 0;
 
 	switch (m) {
 		case CH_ARRAY:
-			_sl.array_index = 0;
+			_sl_chunk.array_index = 0;
 			if (ch->load_check_proc) {
 				ch->load_check_proc();
 			} else {
@@ -1670,7 +1847,7 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
 				/* Read length */
 				len = (SlReadByte() << 16) | ((m >> 4) << 24);
 				len += SlReadUint16();
-				_sl.obj_len = len;
+				_sl_chunk.obj_len = len;
 				endoffs = _sl.reader->GetSize() + len;
 				if (ch->load_check_proc) {
 					ch->load_check_proc();
@@ -1689,7 +1866,7 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
  * Stub Chunk handlers to only calculate length and do nothing else.
  * The intended chunk handler that should be called.
  */
-static ChunkSaveLoadProc *_stub_save_proc;
+static thread_local ChunkSaveLoadProc *_stub_save_proc;
 
 /**
  * Stub Chunk handlers to only calculate length and do nothing else.
@@ -1714,17 +1891,17 @@ static void SlStubSaveProc()
 /**
  * Save a chunk of data (eg. vehicles, stations, etc.). Each chunk is
  * prefixed by an ID identifying it, followed by data, and terminator where appropriate
- * @param ch The chunkhandler that will be used for the operation
+ * @param ch The chunkhandler that will be used for the operation, it must have a save handler
+ * @return The time it took to save the chunk, in milliseconds.
+ * @note Chunks may be saved by several threads at once, so this must not log anything.
  */
-static void SlSaveChunk(const ChunkHandler *ch)
+static int SlSaveChunk(const ChunkHandler *ch)
 {
 	ChunkSaveLoadProc *proc = ch->save_proc;
+	assert(proc != nullptr);
 
-	/* Don't save any chunk information if there is no save handler. */
-	if (proc == nullptr) return;
-
+	auto start = std::chrono::steady_clock::now();
 	SlWriteUint32(ch->id);
-	DEBUG(sl, 2, "Saving chunk %c%c%c%c", ch->id >> 24, ch->id >> 16, ch->id >> 8, ch->id);
 
 	if (ch->flags & CH_AUTO_LENGTH) {
 		/* Need to calculate the length. Solve that by calling SlAutoLength in the save_proc. */
@@ -1732,14 +1909,14 @@ static void SlSaveChunk(const ChunkHandler *ch)
 		proc = SlStubSaveProc;
 	}
 
-	_sl.block_mode = ch->flags & CH_TYPE_MASK;
+	_sl_chunk.block_mode = ch->flags & CH_TYPE_MASK;
 	switch (ch->flags & CH_TYPE_MASK) {
 		case CH_RIFF:
-			_sl.need_length = NL_WANTLENGTH;
+			_sl_chunk.need_length = NL_WANTLENGTH;
 			proc();
 			break;
 		case CH_ARRAY:
-			_sl.last_array_index = 0;
+			_sl_chunk.last_array_index = 0;
 			SlWriteByte(CH_ARRAY);
 			proc();
 			SlWriteArrayLength(0); // Terminate arrays
@@ -1751,19 +1928,104 @@ static void SlSaveChunk(const ChunkHandler *ch)
 			break;
 		default: NOT_REACHED();
 	}
+
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Log how long saving a chunk took and how large it became.
+ * @param ch The chunkhandler of the saved chunk.
+ * @param size The size of the saved chunk, in bytes.
+ * @param time The time it took to save the chunk, in milliseconds.
+ */
+static void SlDebugSavedChunk(const ChunkHandler *ch, size_t size, int time)
+{
+	DEBUG(sl, 2, "Saved chunk %c%c%c%c: " PRINTF_SIZE " bytes in %d ms", ch->id >> 24, ch->id >> 16, ch->id >> 8, ch->id, size, time);
+}
+
+/** Start a new segment of the savegame in memory and make it the one being written to. */
+static void SlStartSaveSegment()
+{
+	_sl_chunk.dumper = new MemoryDumper();
+	_sl.segments.push_back({_sl_chunk.dumper, nullptr, 0});
 }
 
-/** Save all chunks */
+/**
+ * Save all chunks. Chunks that can be saved from a snapshot only get
+ * a placeholder; they are saved by #SlSaveSnapshotChunks.
+ */
 static void SlSaveChunks()
 {
+	SlStartSaveSegment();
+
 	FOR_ALL_CHUNK_HANDLERS(ch) {
-		SlSaveChunk(ch);
+		/* Don't save any chunk information if there is no save handler. */
+		if (ch->save_proc == nullptr) continue;
+
+		if ((ch->flags & CH_SNAPSHOT) != 0) {
+			_sl.segments.push_back({nullptr, ch, 0});
+			SlStartSaveSegment();
+			continue;
+		}
+
+		DEBUG(sl, 2, "Saving chunk %c%c%c%c", ch->id >> 24, ch->id >> 16, ch->id >> 8, ch->id);
+		size_t start_size = _sl_chunk.dumper->GetSize();
+		int time = SlSaveChunk(ch);
+		SlDebugSavedChunk(ch, _sl_chunk.dumper->GetSize() - start_size, time);
 	}
 
 	/* Terminator */
 	SlWriteUint32(0);
 }
 
+/**
+ * Save the chunks that were skipped by #SlSaveChunks into their own segments.
+ * This may run on the save thread, while the game continues. These chunks only
+ * read from their snapshot, so they are saved by several threads at once.
+ */
+static void SlSaveSnapshotChunks()
+{
+	std::vector<SaveSegment *> todo;
+	for (SaveSegment &segment : _sl.segments) {
+		if (segment.ch != nullptr) todo.push_back(&segment);
+	}
+
+	std::atomic<size_t> next(0);
+	std::mutex error_lock;
+	std::exception_ptr error;
+
+	/* Each thread, including this one, saves the next chunk nobody else took yet. */
+	auto save_chunks = [&]() {
+		for (size_t i = next++; i < todo.size(); i = next++) {
+			try {
+				_sl_chunk.dumper = todo[i]->dumper = new MemoryDumper();
+				todo[i]->save_time = SlSaveChunk(todo[i]->ch);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(error_lock);
+				if (!error) error = std::current_exception();
+			}
+		}
+		_sl_chunk.dumper = nullptr;
+	};
+
+	std::vector<std::thread> threads;
+	uint count = Clamp(std::thread::hardware_concurrency(), 1, 8);
+	for (uint i = 1; i < count && i < todo.size(); i++) {
+		std::thread t;
+		if (!StartNewThread(&t, "ottd:savechunk", [&]() { save_chunks(); })) break;
+		threads.push_back(std::move(t));
+	}
+	save_chunks();
+	for (std::thread &t : threads) t.join();
+
+	FreeMapSaveSource();
+
+	if (error) std::rethrow_exception(error);
+
+	/* This may run on the save thread, where logging is not allowed; SaveFileDone logs these. */
+	for (const SaveSegment *segment : todo) _sl.saved_chunks.push_back({segment->ch, segment->dumper->GetSize(), segment->save_time});
+}
+
 /**
  * Find the ChunkHandler that will be used for processing the found
  * chunk in the savegame or in memory
@@ -1787,7 +2049,11 @@ static void SlLoadChunks()
 
 		ch = SlFindChunkHandler(id);
 		if (ch == nullptr) SlErrorCorrupt("Unknown chunk type");
+
+		auto start = std::chrono::steady_clock::now();
 		SlLoadChunk(ch);
+		DEBUG(sl, 2, "Loaded chunk %c%c%c%c in %d ms", id >> 24, id >> 16, id >> 8, id,
+				(int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 	}
 }
 
@@ -1828,20 +2094,27 @@ static void SlFixPointers()
 
 /** Yes, simply reading from a file. */
 struct FileReader : LoadFilter {
-	FILE *file; ///< The file to read from.
-	long begin; ///< The begin of the file.
+	FILE *file;       ///< The file to read from.
+	long begin;       ///< The begin of the file.
+
+	const byte *map;  ///< The file mapped into memory, once it has been read directly, or \c nullptr.
+	size_t map_size;  ///< Size of the mapping.
+	size_t map_pos;   ///< Position in the mapping.
 
 	/**
 	 * Create the file reader, so it reads from a specific file.
 	 * @param file The file to read from.
 	 */
-	FileReader(FILE *file) : LoadFilter(nullptr), file(file), begin(ftell(file))
+	FileReader(FILE *file) : LoadFilter(nullptr), file(file), begin(ftell(file)), map(nullptr), map_size(0), map_pos(0)
 	{
 	}
 
 	/** Make sure everything is cleaned up. */
 	~FileReader()
 	{
+#if defined(UNIX)
+		if (this->map != nullptr) munmap(const_cast<byte *>(this->map), this->map_size);
+#endif
 		if (this->file != nullptr) fclose(this->file);
 		this->file = nullptr;
 
@@ -1851,14 +2124,54 @@ struct FileReader : LoadFilter {
 
 	size_t Read(byte *buf, size_t size) override
 	{
+		if (this->map != nullptr) {
+			size = min(size, this->map_size - this->map_pos);
+			memcpy(buf, this->map + this->map_pos, size);
+			this->map_pos += size;
+			return size;
+		}
+
 		/* We're in the process of shutting down, i.e. in "failure" mode. */
 		if (this->file == nullptr) return 0;
 
 		return fread(buf, 1, size, this->file);
 	}
 
+	const byte *ReadDirect(size_t *len) override
+	{
+#if defined(UNIX)
+		/* Map the file the first time, from where we are now; from then on everything is read from the mapping. */
+		if (this->map == nullptr && this->file != nullptr) {
+			struct stat st;
+			long pos = ftell(this->file);
+			if (pos < 0 || fstat(fileno(this->file), &st) != 0 || st.st_size <= pos || (uint64)st.st_size > SIZE_MAX) return nullptr;
+
+			void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(this->file), 0);
+			if (map == MAP_FAILED) return nullptr;
+			posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+			this->map = (const byte *)map;
+			this->map_size = st.st_size;
+			this->map_pos = pos;
+		}
+
+		if (this->map != nullptr) {
+			*len = this->map_size - this->map_pos;
+			const byte *data = this->map + this->map_pos;
+			this->map_pos = this->map_size;
+			return data;
+		}
+#endif
+		return nullptr;
+	}
+
 	void Reset() override
 	{
+		if (this->map != nullptr) {
+			this->map_pos = this->begin;
+			return;
+		}
+
 		clearerr(this->file);
 		if (fseek(this->file, this->begin, SEEK_SET)) {
 			DEBUG(sl, 1, "Could not reset the file reading");
@@ -1902,6 +2215,159 @@ struct FileWriter : SaveFilter {
 	}
 };
 
+/**
+ * Filter that decompresses the savegame on a separate thread, into a bounded queue of
+ * buffers, while the main thread is busy loading the chunks from the previous ones.
+ */
+struct ReadAheadLoadFilter : LoadFilter {
+	static const size_t BUFFER_SIZE = MEMORY_CHUNK_SIZE; ///< Size of each buffer.
+	static const size_t MAX_BUFFERS = 16;                ///< Maximum number of filled buffers that are waiting to be read.
+
+	std::thread thread;                     ///< Thread reading from the next filter.
+	std::mutex lock;                        ///< Lock for everything below.
+	std::condition_variable changed;        ///< Signalled when a buffer is filled or emptied, or when stopping.
+	std::deque<std::vector<byte>> filled;   ///< Buffers that have been read, but not yet returned; an empty one marks the end.
+	std::vector<std::vector<byte>> spare;   ///< Buffers that can be reused.
+	std::exception_ptr error;               ///< Error while reading ahead.
+	bool stop;                              ///< Whether the thread has to stop reading.
+
+	std::vector<byte> current;              ///< The buffer being returned.
+	size_t pos;                             ///< Position in the current buffer.
+	bool end;                               ///< Whether the end of the savegame has been reached.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	ReadAheadLoadFilter(LoadFilter *chain) : LoadFilter(chain), stop(false), pos(0), end(false)
+	{
+		this->Start();
+	}
+
+	/** Clean up our mess. */
+	~ReadAheadLoadFilter()
+	{
+		this->Stop();
+	}
+
+	/** Start reading ahead; when that is not possible, everything is read on demand. */
+	void Start()
+	{
+		this->stop = false;
+		if (!StartNewThread(&this->thread, "ottd:readahead", [this]() { this->ReadAhead(); })) {
+			DEBUG(sl, 1, "Cannot create read ahead thread, reading the savegame on demand...");
+		}
+	}
+
+	/** Stop reading ahead, and wait for the thread to finish. */
+	void Stop()
+	{
+		if (!this->thread.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->stop = true;
+		}
+		this->changed.notify_all();
+		this->thread.join();
+	}
+
+	/** Read buffers from the next filter, until the end of the savegame or when told to stop. */
+	void ReadAhead()
+	{
+		_sl_read_ahead_thread = true;
+
+		for (;;) {
+			std::vector<byte> buf;
+			{
+				std::unique_lock<std::mutex> guard(this->lock);
+				this->changed.wait(guard, [this]() { return this->stop || this->filled.size() < MAX_BUFFERS; });
+				if (this->stop) return;
+
+				if (!this->spare.empty()) {
+					buf = std::move(this->spare.back());
+					this->spare.pop_back();
+				}
+			}
+
+			buf.resize(BUFFER_SIZE);
+			size_t len = 0;
+			try {
+				for (size_t read; len < BUFFER_SIZE && (read = this->chain->Read(buf.data() + len, BUFFER_SIZE - len)) != 0;) len += read;
+			} catch (...) {
+				std::lock_guard<std::mutex> guard(this->lock);
+				this->error = std::current_exception();
+				this->changed.notify_all();
+				return;
+			}
+			buf.resize(len);
+
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->filled.push_back(std::move(buf));
+			this->changed.notify_all();
+			if (len == 0) return;
+		}
+	}
+
+	/**
+	 * Get the next buffer that has been read ahead.
+	 * @return False when the end of the savegame has been reached.
+	 */
+	bool NextBuffer()
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->changed.wait(guard, [this]() { return !this->filled.empty() || this->error; });
+		if (this->filled.empty()) {
+			/* The pointers can only be cleared here, as the pools are being loaded on this thread. */
+			guard.unlock();
+			SlNullPointers();
+			std::rethrow_exception(this->error);
+		}
+
+		this->spare.push_back(std::move(this->current));
+		this->current = std::move(this->filled.front());
+		this->filled.pop_front();
+		this->pos = 0;
+		this->changed.notify_all();
+		return !this->current.empty();
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		if (!this->thread.joinable()) return this->chain->Read(buf, size);
+
+		size_t read = 0;
+		while (read < size && !this->end) {
+			if (this->pos == this->current.size()) {
+				if (!this->NextBuffer()) {
+					this->end = true;
+					break;
+				}
+				continue;
+			}
+
+			size_t len = min(this->current.size() - this->pos, size - read);
+			memcpy(buf + read, this->current.data() + this->pos, len);
+			this->pos += len;
+			read += len;
+		}
+		return read;
+	}
+
+	void Reset() override
+	{
+		this->Stop();
+		this->chain->Reset();
+
+		this->filled.clear();
+		this->current.clear();
+		this->error = nullptr;
+		this->pos = 0;
+		this->end = false;
+		this->Start();
+	}
+};
+
 /*******************************************
  ********** START OF LZO CODE **************
  *******************************************/
@@ -2014,6 +2480,11 @@ struct NoCompLoadFilter : LoadFilter {
 	{
 		return this->chain->Read(buf, size);
 	}
+
+	const byte *ReadDirect(size_t *len) override
+	{
+		return this->chain->ReadDirect(len);
+	}
 };
 
 /** Filter without any compression. */
@@ -2152,69 +2623,401 @@ struct ZlibSaveFilter : SaveFilter {
 	}
 };
 
-#endif /* WITH_ZLIB */
+/*******************************************
+ ****** START OF BLOCK-PARALLEL ZLIB CODE ***
+ *******************************************/
 
-/********************************************
- ********** START OF LZMA CODE **************
- ********************************************/
+/*
+ * The block-parallel format splits the savegame into blocks of at most
+ * PARALLEL_BLOCK_SIZE bytes that are compressed independently. Each block
+ * is stored as its uncompressed size and compressed size (both big endian
+ * uint32) followed by the zlib stream of the block. A block with both sizes
+ * zero marks the end. As blocks do not depend on each other, they can be
+ * compressed and decompressed by several threads at the same time.
+ */
 
-#if defined(WITH_LIBLZMA)
-#include <lzma.h>
+/** Size of the uncompressed data of a block of the block-parallel format. */
+static const size_t PARALLEL_BLOCK_SIZE = 1024 * 1024;
+
+/** A single block of the block-parallel format. */
+struct ParallelBlock {
+	std::vector<byte> in;  ///< The data to process.
+	std::vector<byte> out; ///< The processed data.
+	bool done;             ///< Whether processing the block has finished.
+	bool failed;           ///< Whether processing the block has failed.
+
+	ParallelBlock() : done(false), failed(false) {}
+};
 
 /**
- * Have a copy of an initialised LZMA stream. We need this as it's
- * impossible to "re"-assign LZMA_STREAM_INIT to a variable in some
- * compilers, i.e. LZMA_STREAM_INIT can't be used to set something.
- * This var has to be used instead.
+ * Function to (de)compress a block.
+ * @param block The block to process; the result goes into \c block->out.
+ * @param level The compression level.
+ * @return True iff processing succeeded.
  */
-static const lzma_stream _lzma_init = LZMA_STREAM_INIT;
+typedef bool ParallelBlockProc(ParallelBlock *block, int level);
 
-/** Filter without any compression. */
-struct LZMALoadFilter : LoadFilter {
-	lzma_stream lzma;                  ///< Stream state that we are reading from.
-	byte fread_buf[MEMORY_CHUNK_SIZE]; ///< Buffer for reading from the file.
+/**
+ * Pool of worker threads processing blocks. Blocks are handed out in the
+ * order they are submitted, and can only be collected in that order as well.
+ * When no worker threads could be started, blocks are processed directly
+ * when they are submitted.
+ */
+class ParallelBlockPool {
+	ParallelBlockProc *proc;                ///< Function to process a block with.
+	int level;                              ///< Compression level to pass to #proc.
+	std::vector<std::thread> workers;       ///< The worker threads.
+	std::mutex lock;                        ///< Lock for everything below.
+	std::condition_variable work_available; ///< Signalled when blocks are submitted or the pool is shut down.
+	std::condition_variable work_done;      ///< Signalled when a block has been processed.
+	std::deque<ParallelBlock *> pending;    ///< Blocks that still have to be processed.
+	std::deque<ParallelBlock *> blocks;     ///< All blocks that have not been collected, in submission order.
+	bool exit;                              ///< Whether the workers have to stop.
+
+	/** Main loop of the worker threads. */
+	void WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(this->lock);
+		for (;;) {
+			while (!this->exit && this->pending.empty()) this->work_available.wait(lock);
+			if (this->exit) return;
+
+			ParallelBlock *block = this->pending.front();
+			this->pending.pop_front();
 
+			lock.unlock();
+			bool ok = this->proc(block, this->level);
+			lock.lock();
+
+			block->failed = !ok;
+			block->done = true;
+			this->work_done.notify_all();
+		}
+	}
+
+public:
 	/**
-	 * Initialise this filter.
-	 * @param chain The next filter in this chain.
+	 * Create the pool and start the worker threads.
+	 * @param proc  Function to process the blocks with.
+	 * @param level Compression level passed to \a proc.
 	 */
-	LZMALoadFilter(LoadFilter *chain) : LoadFilter(chain), lzma(_lzma_init)
+	ParallelBlockPool(ParallelBlockProc *proc, int level) : proc(proc), level(level), exit(false)
 	{
-		/* Allow saves up to 256 MB uncompressed */
-		if (lzma_auto_decoder(&this->lzma, 1 << 28, 0) != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize decompressor");
+		uint count = Clamp(std::thread::hardware_concurrency(), 1, 8);
+		for (uint i = 0; i < count; i++) {
+			std::thread t;
+			if (!StartNewThread(&t, "ottd:compress", [this]() { this->WorkerLoop(); })) break;
+			this->workers.push_back(std::move(t));
+		}
+		if (this->workers.empty()) DEBUG(sl, 1, "Cannot create compression threads, reverting to single-threaded mode...");
 	}
 
-	/** Clean everything up. */
-	~LZMALoadFilter()
+	/** Stop the workers and free all blocks that were not collected. */
+	~ParallelBlockPool()
 	{
-		lzma_end(&this->lzma);
+		{
+			std::lock_guard<std::mutex> lock(this->lock);
+			this->exit = true;
+			this->work_available.notify_all();
+		}
+		for (std::thread &t : this->workers) t.join();
+		for (ParallelBlock *block : this->blocks) delete block;
 	}
 
-	size_t Read(byte *buf, size_t size) override
+	/**
+	 * Get the number of blocks that are in the pool, i.e. submitted but not yet collected.
+	 * @return The number of blocks.
+	 */
+	size_t InFlight() const
 	{
-		this->lzma.next_out  = buf;
-		this->lzma.avail_out = size;
-
-		do {
-			/* read more bytes from the file? */
-			if (this->lzma.avail_in == 0) {
-				this->lzma.next_in  = this->fread_buf;
-				this->lzma.avail_in = this->chain->Read(this->fread_buf, sizeof(this->fread_buf));
-			}
-
-			/* inflate the data */
-			lzma_ret r = lzma_code(&this->lzma, LZMA_RUN);
-			if (r == LZMA_STREAM_END) break;
-			if (r != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "liblzma returned error code");
-		} while (this->lzma.avail_out != 0);
-
-		return size - this->lzma.avail_out;
+		return this->blocks.size();
 	}
-};
-
-/** Filter using LZMA compression. */
-struct LZMASaveFilter : SaveFilter {
-	lzma_stream lzma; ///< Stream state that we are writing to.
+
+	/**
+	 * Get the number of blocks that may be in flight before waiting for them.
+	 * @return The maximum number of blocks in flight.
+	 */
+	size_t MaxInFlight() const
+	{
+		return 2 * max<size_t>(1, this->workers.size());
+	}
+
+	/**
+	 * Submit a block for processing. The pool takes ownership of the block until it is collected.
+	 * @param block The block to process.
+	 */
+	void Submit(ParallelBlock *block)
+	{
+		if (this->workers.empty()) {
+			block->failed = !this->proc(block, this->level);
+			block->done = true;
+			this->blocks.push_back(block);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(this->lock);
+		this->blocks.push_back(block);
+		this->pending.push_back(block);
+		this->work_available.notify_one();
+	}
+
+	/**
+	 * Collect the oldest block that was submitted.
+	 * @param wait Whether to wait for the block to be processed.
+	 * @return The processed block, owned by the caller, or \c nullptr if there is no block
+	 *         or when the oldest block is not processed yet and \a wait is false.
+	 */
+	ParallelBlock *Collect(bool wait)
+	{
+		std::unique_lock<std::mutex> lock(this->lock);
+		if (this->blocks.empty()) return nullptr;
+
+		ParallelBlock *block = this->blocks.front();
+		if (!block->done) {
+			if (!wait) return nullptr;
+			while (!block->done) this->work_done.wait(lock);
+		}
+		this->blocks.pop_front();
+		return block;
+	}
+};
+
+/**
+ * Compress a block with zlib.
+ * @param block The block to compress.
+ * @param level The compression level.
+ * @return True iff compressing succeeded.
+ */
+static bool CompressParallelZlibBlock(ParallelBlock *block, int level)
+{
+	uLongf len = compressBound((uLong)block->in.size());
+	block->out.resize(len);
+	if (compress2(block->out.data(), &len, block->in.data(), (uLong)block->in.size(), level) != Z_OK) return false;
+	block->out.resize(len);
+	return true;
+}
+
+/**
+ * Decompress a block with zlib.
+ * @param block The block to decompress; \c block->out must already have the uncompressed size.
+ * @param level Unused.
+ * @return True iff decompressing succeeded.
+ */
+static bool DecompressParallelZlibBlock(ParallelBlock *block, int level)
+{
+	uLongf len = (uLongf)block->out.size();
+	return uncompress(block->out.data(), &len, block->in.data(), (uLong)block->in.size()) == Z_OK && len == block->out.size();
+}
+
+/** Filter using block-parallel Zlib compression. */
+struct ParallelZlibLoadFilter : LoadFilter {
+	ParallelBlockPool pool; ///< The workers decompressing the blocks.
+	ParallelBlock *current; ///< The block we are currently reading from.
+	size_t pos;             ///< The position in the current block.
+	bool eof;               ///< Whether the end marker has been read.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	ParallelZlibLoadFilter(LoadFilter *chain) : LoadFilter(chain), pool(&DecompressParallelZlibBlock, 0), current(nullptr), pos(0), eof(false)
+	{
+	}
+
+	/** Clean everything up. */
+	~ParallelZlibLoadFilter()
+	{
+		delete this->current;
+	}
+
+	/** Read blocks from the file and hand them to the workers, until enough are in flight. */
+	void FillPipeline()
+	{
+		while (!this->eof && this->pool.InFlight() < this->pool.MaxInFlight()) {
+			uint32 hdr[2];
+			if (this->chain->Read((byte*)hdr, sizeof(hdr)) != sizeof(hdr)) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE, "File read failed");
+
+			uint32 size = TO_BE32(hdr[0]);
+			uint32 compressed = TO_BE32(hdr[1]);
+			if (size == 0 && compressed == 0) {
+				this->eof = true;
+				break;
+			}
+			if (size == 0 || size > PARALLEL_BLOCK_SIZE || compressed > compressBound(PARALLEL_BLOCK_SIZE)) SlErrorCorrupt("Inconsistent block size");
+
+			ParallelBlock *block = new ParallelBlock();
+			block->in.resize(compressed);
+			block->out.resize(size);
+			if (this->chain->Read(block->in.data(), compressed) != compressed) {
+				delete block;
+				SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+			}
+			this->pool.Submit(block);
+		}
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size_t read = 0;
+		while (read < size) {
+			if (this->current == nullptr || this->pos == this->current->out.size()) {
+				delete this->current;
+				this->FillPipeline();
+				this->current = this->pool.Collect(true);
+				this->pos = 0;
+				if (this->current == nullptr) break;
+				if (this->current->failed) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "uncompress() failed");
+			}
+
+			size_t len = min(size - read, this->current->out.size() - this->pos);
+			memcpy(buf + read, this->current->out.data() + this->pos, len);
+			this->pos += len;
+			read += len;
+		}
+		return read;
+	}
+};
+
+/** Filter using block-parallel Zlib compression. */
+struct ParallelZlibSaveFilter : SaveFilter {
+	ParallelBlockPool pool; ///< The workers compressing the blocks.
+	ParallelBlock *current; ///< The block we are currently filling.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	ParallelZlibSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain), pool(&CompressParallelZlibBlock, compression_level), current(nullptr)
+	{
+	}
+
+	/** Clean up what we allocated. */
+	~ParallelZlibSaveFilter()
+	{
+		delete this->current;
+	}
+
+	/**
+	 * Write the compressed blocks to the next filter.
+	 * @param wait_all Whether to wait until all blocks are written; otherwise
+	 *                 only wait when too many blocks are in flight.
+	 */
+	void WriteBlocks(bool wait_all)
+	{
+		for (;;) {
+			ParallelBlock *block = this->pool.Collect(wait_all || this->pool.InFlight() > this->pool.MaxInFlight());
+			if (block == nullptr) return;
+
+			bool failed = block->failed;
+			uint32 hdr[2] = { TO_BE32((uint32)block->in.size()), TO_BE32((uint32)block->out.size()) };
+			if (!failed) {
+				this->chain->Write((byte*)hdr, sizeof(hdr));
+				this->chain->Write(block->out.data(), block->out.size());
+			}
+			delete block;
+			if (failed) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "zlib returned error code");
+		}
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		while (size > 0) {
+			if (this->current == nullptr) {
+				this->current = new ParallelBlock();
+				this->current->in.reserve(PARALLEL_BLOCK_SIZE);
+			}
+
+			size_t len = min(size, PARALLEL_BLOCK_SIZE - this->current->in.size());
+			this->current->in.insert(this->current->in.end(), buf, buf + len);
+			buf += len;
+			size -= len;
+
+			if (this->current->in.size() == PARALLEL_BLOCK_SIZE) {
+				this->pool.Submit(this->current);
+				this->current = nullptr;
+				this->WriteBlocks(false);
+			}
+		}
+	}
+
+	void Finish() override
+	{
+		if (this->current != nullptr) {
+			this->pool.Submit(this->current);
+			this->current = nullptr;
+		}
+		this->WriteBlocks(true);
+
+		uint32 end[2] = { 0, 0 };
+		this->chain->Write((byte*)end, sizeof(end));
+		this->chain->Finish();
+	}
+};
+
+#endif /* WITH_ZLIB */
+
+/********************************************
+ ********** START OF LZMA CODE **************
+ ********************************************/
+
+#if defined(WITH_LIBLZMA)
+#include <lzma.h>
+
+/**
+ * Have a copy of an initialised LZMA stream. We need this as it's
+ * impossible to "re"-assign LZMA_STREAM_INIT to a variable in some
+ * compilers, i.e. LZMA_STREAM_INIT can't be used to set something.
+ * This var has to be used instead.
+ */
+static const lzma_stream _lzma_init = LZMA_STREAM_INIT;
+
+/** Filter without any compression. */
+struct LZMALoadFilter : LoadFilter {
+	lzma_stream lzma;                  ///< Stream state that we are reading from.
+	byte fread_buf[MEMORY_CHUNK_SIZE]; ///< Buffer for reading from the file.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	LZMALoadFilter(LoadFilter *chain) : LoadFilter(chain), lzma(_lzma_init)
+	{
+		/* Allow saves up to 256 MB uncompressed */
+		if (lzma_auto_decoder(&this->lzma, 1 << 28, 0) != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize decompressor");
+	}
+
+	/** Clean everything up. */
+	~LZMALoadFilter()
+	{
+		lzma_end(&this->lzma);
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		this->lzma.next_out  = buf;
+		this->lzma.avail_out = size;
+
+		do {
+			/* read more bytes from the file? */
+			if (this->lzma.avail_in == 0) {
+				this->lzma.next_in  = this->fread_buf;
+				this->lzma.avail_in = this->chain->Read(this->fread_buf, sizeof(this->fread_buf));
+			}
+
+			/* inflate the data */
+			lzma_ret r = lzma_code(&this->lzma, LZMA_RUN);
+			if (r == LZMA_STREAM_END) break;
+			if (r != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "liblzma returned error code");
+		} while (this->lzma.avail_out != 0);
+
+		return size - this->lzma.avail_out;
+	}
+};
+
+/** Filter using LZMA compression. */
+struct LZMASaveFilter : SaveFilter {
+	lzma_stream lzma; ///< Stream state that we are writing to.
 
 	/**
 	 * Initialise this filter.
@@ -2273,6 +3076,431 @@ struct LZMASaveFilter : SaveFilter {
 
 #endif /* WITH_LIBLZMA */
 
+/********************************************
+ ********** START OF ZSTD CODE **************
+ ********************************************/
+
+#if defined(WITH_ZSTD)
+#include <zstd.h>
+
+/** Filter using Zstandard compression. */
+struct ZstdLoadFilter : LoadFilter {
+	ZSTD_DCtx *zstd;                   ///< Stream state we are reading from.
+	ZSTD_inBuffer input;               ///< The part of #fread_buf that still has to be decompressed.
+	byte fread_buf[MEMORY_CHUNK_SIZE]; ///< Buffer for reading from the file.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 */
+	ZstdLoadFilter(LoadFilter *chain) : LoadFilter(chain), zstd(ZSTD_createDCtx())
+	{
+		if (this->zstd == nullptr) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize decompressor");
+		this->input.src = this->fread_buf;
+		this->input.size = 0;
+		this->input.pos = 0;
+	}
+
+	/** Clean everything up. */
+	~ZstdLoadFilter()
+	{
+		ZSTD_freeDCtx(this->zstd);
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		ZSTD_outBuffer output = { buf, size, 0 };
+
+		do {
+			/* read more bytes from the file? */
+			if (this->input.pos == this->input.size) {
+				this->input.size = this->chain->Read(this->fread_buf, sizeof(this->fread_buf));
+				this->input.pos = 0;
+				if (this->input.size == 0) break;
+			}
+
+			/* decompress the data */
+			size_t r = ZSTD_decompressStream(this->zstd, &output, &this->input);
+			if (ZSTD_isError(r)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "libzstd returned error code");
+			if (r == 0) break; // end of the frame
+		} while (output.pos != output.size);
+
+		return output.pos;
+	}
+};
+
+/** Filter using Zstandard compression. */
+struct ZstdSaveFilter : SaveFilter {
+	ZSTD_CCtx *zstd; ///< Stream state we are writing to.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain             The next filter in this chain.
+	 * @param compression_level The requested level of compression.
+	 */
+	ZstdSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain), zstd(ZSTD_createCCtx())
+	{
+		if (this->zstd == nullptr || ZSTD_isError(ZSTD_CCtx_setParameter(this->zstd, ZSTD_c_compressionLevel, compression_level))) {
+			SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize compressor");
+		}
+	}
+
+	/** Clean up what we allocated. */
+	~ZstdSaveFilter()
+	{
+		ZSTD_freeCCtx(this->zstd);
+	}
+
+	/**
+	 * Helper loop for writing the data.
+	 * @param p    The bytes to write.
+	 * @param len  Amount of bytes to write.
+	 * @param mode Mode for ZSTD_compressStream2.
+	 */
+	void WriteLoop(byte *p, size_t len, ZSTD_EndDirective mode)
+	{
+		byte buf[MEMORY_CHUNK_SIZE]; // output buffer
+		ZSTD_inBuffer input = { p, len, 0 };
+		bool finished;
+		do {
+			ZSTD_outBuffer output = { buf, sizeof(buf), 0 };
+
+			size_t remaining = ZSTD_compressStream2(this->zstd, &output, &input, mode);
+			if (ZSTD_isError(remaining)) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "libzstd returned error code");
+
+			/* bytes were emitted? */
+			if (output.pos != 0) this->chain->Write(buf, output.pos);
+
+			/* When ending the frame, everything has to be flushed; otherwise all input has to be consumed. */
+			finished = (mode == ZSTD_e_end) ? (remaining == 0) : (input.pos == input.size);
+		} while (!finished);
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		this->WriteLoop(buf, size, ZSTD_e_continue);
+	}
+
+	void Finish() override
+	{
+		this->WriteLoop(nullptr, 0, ZSTD_e_end);
+		this->chain->Finish();
+	}
+};
+
+#endif /* WITH_ZSTD */
+
+/********************************************
+ ********** START OF DELTA CODE *************
+ ********************************************/
+
+/** Tag of delta savegames; the tag of the format the differences are compressed with follows the summary. */
+static const uint32 DELTA_SAVEGAME_TAG = TO_BE32X('OTTR');
+
+/* The uncompressed savegame is split into blocks whose boundaries are determined by their contents, so data that
+ * is inserted or removed, e.g. when a vehicle is bought, only changes the blocks around it and not everything after. */
+static const size_t DELTA_BLOCK_MIN = 2 * 1024;   ///< Minimum size of a block.
+static const size_t DELTA_BLOCK_MAX = 64 * 1024;  ///< Maximum size of a block.
+static const uint64 DELTA_BLOCK_MASK = 0x1FFF;    ///< A block ends when these bits of the rolling hash are 0; about 8 KiB on average.
+static const size_t DELTA_LITERAL_MAX = 1 << 20;  ///< Maximum size of a literal record.
+
+/** Types of the records of a delta savegame. */
+enum DeltaRecordType {
+	DELTA_RECORD_END     = 0, ///< End of the savegame.
+	DELTA_RECORD_COPY    = 1, ///< Skip some data of the base savegame and then copy data from it; followed by both lengths.
+	DELTA_RECORD_LITERAL = 2, ///< Data that is not in the base savegame; followed by its length and the data itself.
+};
+
+/** Table with a random value for each byte, used by the rolling hash that determines the block boundaries. */
+static const struct DeltaGearTable {
+	uint64 value[256]; ///< The value for each byte.
+
+	DeltaGearTable()
+	{
+		/* The values have to be the same every time, otherwise the blocks of two savegames do not match. */
+		uint64 seed = 0x9E3779B97F4A7C15ULL;
+		for (uint i = 0; i < lengthof(this->value); i++) {
+			uint64 z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			this->value[i] = z ^ (z >> 31);
+		}
+	}
+} _delta_gear;
+
+typedef std::array<uint8, 16> DeltaBlockDigest; ///< MD5 digest of a block.
+
+/** The blocks of a complete savegame, that the following delta savegames refer to. */
+struct DeltaSaveBase {
+	std::string filename;  ///< Name of the savegame, without directory.
+	uint64 size;           ///< Size of the uncompressed savegame data.
+	uint8 md5sum[16];      ///< MD5 digest of the uncompressed savegame data.
+	std::map<DeltaBlockDigest, std::vector<uint64>> blocks; ///< Offsets of the blocks, in ascending order, by their digest.
+};
+
+static DeltaSaveBase *_delta_base = nullptr; ///< Base of the next delta savegame, or \c nullptr when there is none.
+
+/** The uncompressed data of the base savegame that was loaded last, so loading more delta savegames with the same base does not decompress it again. */
+struct DeltaLoadBase {
+	std::string filename;                          ///< Name of the savegame, without directory.
+	uint8 md5sum[16];                              ///< MD5 digest of the data.
+	std::shared_ptr<const std::vector<byte>> data; ///< The uncompressed savegame data, or \c nullptr when none was loaded yet.
+};
+
+static DeltaLoadBase _delta_load_base; ///< The base savegame of the delta savegame that was loaded last, until a savegame that is not a delta savegame is loaded.
+
+/** Filter that determines the blocks of a savegame, and writes either all of them or only the ones that changed. */
+struct DeltaSaveFilter : SaveFilter {
+	DeltaSaveBase *base;       ///< The base being made for a checkpoint, or the base to write the differences with.
+	bool checkpoint;           ///< Whether everything is written; otherwise only the differences with the base are written.
+	std::vector<byte> block;   ///< Data of the block that is being determined.
+	uint64 hash;               ///< Rolling hash of the last bytes of the block.
+	uint64 pos;                ///< Position in the written data (checkpoint), or in the base after the last copy (delta).
+	Md5 checksum;              ///< Checksum of all data (checkpoint only).
+	uint64 written_pos;        ///< Position in the base after the last written copy record (delta only).
+	uint64 copy_start;         ///< Start in the base of the pending copy record (delta only).
+	uint64 copy_length;        ///< Length of the pending copy record (delta only).
+	std::vector<byte> literal; ///< Data of the pending literal record (delta only).
+	bool finished;             ///< Whether everything has been written already.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain      The next filter in this chain.
+	 * @param checkpoint Whether to write a checkpoint, i.e. a complete savegame, or the differences with the last one.
+	 * @param filename   Name of the savegame, when writing a checkpoint.
+	 */
+	DeltaSaveFilter(SaveFilter *chain, bool checkpoint, const std::string &filename) : SaveFilter(chain),
+			base(checkpoint ? new DeltaSaveBase() : _delta_base), checkpoint(checkpoint), hash(0), pos(0),
+			written_pos(0), copy_start(0), copy_length(0), finished(false)
+	{
+		if (checkpoint) this->base->filename = filename;
+		this->block.reserve(DELTA_BLOCK_MAX);
+	}
+
+	/** Clean up our mess. */
+	~DeltaSaveFilter()
+	{
+		if (this->checkpoint) delete this->base;
+	}
+
+	/**
+	 * Write a big endian value to the next filter.
+	 * @param value The value to write.
+	 * @param bytes The number of bytes to write the value with.
+	 */
+	void WriteValue(uint64 value, uint bytes)
+	{
+		byte buf[8];
+		for (uint i = 0; i < bytes; i++) buf[i] = GB(value, (bytes - 1 - i) * 8, 8);
+		this->chain->Write(buf, bytes);
+	}
+
+	/** Write the pending copy record, if any. */
+	void FlushCopy()
+	{
+		if (this->copy_length == 0) return;
+
+		this->WriteValue(DELTA_RECORD_COPY, 1);
+		this->WriteValue(this->copy_start - this->written_pos, 8);
+		this->WriteValue(this->copy_length, 8);
+		this->written_pos = this->copy_start + this->copy_length;
+		this->copy_length = 0;
+	}
+
+	/** Write the pending literal record, if any. */
+	void FlushLiteral()
+	{
+		if (this->literal.empty()) return;
+
+		this->WriteValue(DELTA_RECORD_LITERAL, 1);
+		this->WriteValue(this->literal.size(), 8);
+		this->chain->Write(this->literal.data(), this->literal.size());
+		this->literal.clear();
+	}
+
+	/** The current block is complete; write it or refer to the same block in the base. */
+	void EndBlock()
+	{
+		DeltaBlockDigest digest;
+		Md5 md5;
+		md5.Append(this->block.data(), this->block.size());
+		md5.Finish(digest.data());
+
+		if (this->checkpoint) {
+			this->base->blocks[digest].push_back(this->pos);
+			this->pos += this->block.size();
+			this->checksum.Append(this->block.data(), this->block.size());
+			this->chain->Write(this->block.data(), this->block.size());
+		} else {
+			/* The loader reads the base once, so only blocks after the previously copied one can be used. */
+			auto it = this->base->blocks.find(digest);
+			std::vector<uint64>::const_iterator offset;
+			if (it != this->base->blocks.end() && (offset = std::lower_bound(it->second.begin(), it->second.end(), this->pos)) != it->second.end()) {
+				if (this->copy_length == 0 || this->copy_start + this->copy_length != *offset) {
+					this->FlushCopy();
+					this->FlushLiteral();
+					this->copy_start = *offset;
+				}
+				this->copy_length += this->block.size();
+				this->pos = *offset + this->block.size();
+			} else {
+				this->FlushCopy();
+				this->literal.insert(this->literal.end(), this->block.begin(), this->block.end());
+				if (this->literal.size() >= DELTA_LITERAL_MAX) this->FlushLiteral();
+			}
+		}
+
+		this->block.clear();
+		this->hash = 0;
+	}
+
+	void Write(byte *buf, size_t size) override
+	{
+		byte *end = buf + size;
+		while (buf != end) {
+			byte *stop = buf + min<size_t>(end - buf, DELTA_BLOCK_MAX - this->block.size());
+			byte *p = buf;
+			bool boundary = false;
+			while (p != stop) {
+				this->hash = (this->hash << 1) + _delta_gear.value[*p++];
+				if ((this->hash & DELTA_BLOCK_MASK) == 0 && this->block.size() + (p - buf) >= DELTA_BLOCK_MIN) {
+					boundary = true;
+					break;
+				}
+			}
+
+			this->block.insert(this->block.end(), buf, p);
+			buf = p;
+			if (boundary || this->block.size() == DELTA_BLOCK_MAX) this->EndBlock();
+		}
+	}
+
+	void Finish() override
+	{
+		if (!this->finished) {
+			this->finished = true;
+			if (!this->block.empty()) this->EndBlock();
+
+			if (this->checkpoint) {
+				this->base->size = this->pos;
+				this->checksum.Finish(this->base->md5sum);
+
+				/* The savegame is complete, so the next delta savegames can refer to it. */
+				delete _delta_base;
+				_delta_base = this->base;
+				this->base = nullptr;
+				this->checkpoint = false;
+			} else {
+				this->FlushCopy();
+				this->FlushLiteral();
+				this->WriteValue(DELTA_RECORD_END, 1);
+			}
+		}
+
+		this->chain->Finish();
+	}
+};
+
+/**
+ * Read exactly the given number of bytes from a filter.
+ * @param lf  The filter to read from.
+ * @param buf The buffer to read into, or \c nullptr to skip the bytes.
+ * @param len The number of bytes to read.
+ */
+static void SlReadFilterExact(LoadFilter *lf, byte *buf, uint64 len)
+{
+	byte skip[4096];
+	while (len > 0) {
+		size_t to_read = (buf == nullptr) ? min<uint64>(len, sizeof(skip)) : (size_t)min<uint64>(len, SIZE_MAX);
+		size_t read = lf->Read(buf == nullptr ? skip : buf, to_read);
+		if (read == 0) SlError(STR_GAME_SAVELOAD_ERROR_FILE_NOT_READABLE);
+		if (buf != nullptr) buf += read;
+		len -= read;
+	}
+}
+
+/** Filter that combines the records of a delta savegame with the data of its base into the complete savegame. */
+struct DeltaLoadFilter : LoadFilter {
+	std::shared_ptr<const std::vector<byte>> base; ///< The uncompressed data of the base savegame.
+	size_t base_pos;       ///< Position in the base savegame.
+	DeltaRecordType type;  ///< Type of the current record.
+	uint64 remaining;      ///< Data of the current record that still has to be read.
+
+	/**
+	 * Initialise this filter.
+	 * @param chain The next filter in this chain.
+	 * @param base  The uncompressed data of the base savegame.
+	 */
+	DeltaLoadFilter(LoadFilter *chain, std::shared_ptr<const std::vector<byte>> base) : LoadFilter(chain), base(base), base_pos(0), type(DELTA_RECORD_LITERAL), remaining(0)
+	{
+	}
+
+	/**
+	 * Read a big endian value from the next filter.
+	 * @param bytes The number of bytes the value was written with.
+	 * @return The value.
+	 */
+	uint64 ReadValue(uint bytes)
+	{
+		byte buf[8];
+		SlReadFilterExact(this->chain, buf, bytes);
+
+		uint64 value = 0;
+		for (uint i = 0; i < bytes; i++) value = (value << 8) | buf[i];
+		return value;
+	}
+
+	/** Read the header of the next record. */
+	void NextRecord()
+	{
+		this->type = (DeltaRecordType)this->ReadValue(1);
+		switch (this->type) {
+			case DELTA_RECORD_END:
+				break;
+
+			case DELTA_RECORD_COPY: {
+				uint64 skip = this->ReadValue(8);
+				this->remaining = this->ReadValue(8);
+				if (skip > this->base->size() - this->base_pos || this->remaining > this->base->size() - this->base_pos - skip) {
+					SlErrorCorrupt("Delta savegame refers beyond the end of its base");
+				}
+				this->base_pos += (size_t)skip;
+				break;
+			}
+
+			case DELTA_RECORD_LITERAL:
+				this->remaining = this->ReadValue(8);
+				break;
+
+			default:
+				SlErrorCorrupt("Invalid record in delta savegame");
+		}
+	}
+
+	size_t Read(byte *buf, size_t size) override
+	{
+		size_t read = 0;
+		while (read < size) {
+			if (this->remaining == 0) {
+				if (this->type == DELTA_RECORD_END) break;
+				this->NextRecord();
+				continue;
+			}
+
+			size_t len = (size_t)min<uint64>(this->remaining, size - read);
+			if (this->type == DELTA_RECORD_COPY) {
+				memcpy(buf + read, this->base->data() + this->base_pos, len);
+				this->base_pos += len;
+			} else {
+				SlReadFilterExact(this->chain, buf + read, len);
+			}
+			read += len;
+			this->remaining -= len;
+		}
+		return read;
+	}
+};
+
 /*******************************************
  ************* END OF CODE *****************
  *******************************************/
@@ -2300,6 +3528,22 @@ static const SaveLoadFormat _saveload_formats[] = {
 #endif
 	/* Roughly 5 times larger at only 1% of the CPU usage over zlib level 6. */
 	{"none",   TO_BE32X('OTTN'), CreateLoadFilter<NoCompLoadFilter>, CreateSaveFilter<NoCompSaveFilter>, 0, 0, 0},
+#if defined(WITH_ZSTD)
+	/* Level 1 is many times faster than zlib level 6 at a comparable file size, which makes it a good fit for frequent
+	 * autosaves and sending the map to clients. Higher levels get close to lzma level 2 in size while still being faster.
+	 * Levels above 19 need a lot more memory and are therefore not allowed. It is listed before zlib and lzma so it is
+	 * never picked as the default. */
+	{"zstd",   TO_BE32X('OTTS'), CreateLoadFilter<ZstdLoadFilter>,   CreateSaveFilter<ZstdSaveFilter>,   1, 3, 19},
+#else
+	{"zstd",   TO_BE32X('OTTS'), nullptr,                            nullptr,                            0, 0, 0},
+#endif
+#if defined(WITH_ZLIB)
+	/* Zlib on independent blocks of 1 MiB, (de)compressed by a pool of threads. About 1% larger than zlib at the same
+	 * level, but it scales with the number of cores. It is listed before zlib so it is never picked as the default. */
+	{"pzlib",  TO_BE32X('OTTP'), CreateLoadFilter<ParallelZlibLoadFilter>, CreateSaveFilter<ParallelZlibSaveFilter>, 0, 6, 9},
+#else
+	{"pzlib",  TO_BE32X('OTTP'), nullptr,                            nullptr,                            0, 0, 0},
+#endif
 #if defined(WITH_ZLIB)
 	/* After level 6 the speed reduction is significant (1.5x to 2.5x slower per level), but the reduction in filesize is
 	 * fairly insignificant (~1% for each step). Lower levels become ~5-10% bigger by each level than level 6 while level
@@ -2374,6 +3618,317 @@ static const SaveLoadFormat *GetSavegameFormat(char *s, byte *compression_level)
 	return def;
 }
 
+/** The largest savegame summary we are willing to read; anything larger is considered corrupt. */
+static const uint32 MAX_SAVEGAME_SUMMARY_SIZE = 1 << 20;
+
+/**
+ * Append a big endian value to a savegame summary.
+ * @param buf   The summary to append to.
+ * @param value The value to append.
+ * @param bytes The number of bytes to write the value with.
+ */
+static void WriteSummaryValue(std::vector<byte> &buf, uint64 value, uint bytes)
+{
+	for (uint i = bytes; i-- > 0;) buf.push_back(GB(value, i * 8, 8));
+}
+
+/**
+ * Append a string, prefixed by its length, to a savegame summary.
+ * @param buf The summary to append to.
+ * @param str The string to append.
+ */
+static void WriteSummaryString(std::vector<byte> &buf, const char *str)
+{
+	size_t len = min<size_t>(strlen(str), UINT16_MAX);
+	WriteSummaryValue(buf, len, 2);
+	buf.insert(buf.end(), str, str + len);
+}
+
+/**
+ * Create the summary of the current game that is written in front of the savegame data.
+ * It has to be created on the main thread, as it reads the company names via the string system.
+ * @param buf The buffer to write the summary to.
+ */
+static void BuildSavegameSummary(std::vector<byte> &buf)
+{
+	uint32 last_ottd_rev = 0;
+	byte ever_modified = 0;
+	bool removed_newgrfs = false;
+	GamelogInfo(_gamelog_action, _gamelog_actions, &last_ottd_rev, &ever_modified, &removed_newgrfs);
+
+	buf.clear();
+	WriteSummaryValue(buf, _date, 4);
+	WriteSummaryValue(buf, MapSizeX(), 4);
+	WriteSummaryValue(buf, MapSizeY(), 4);
+	WriteSummaryValue(buf, last_ottd_rev, 4);
+	WriteSummaryValue(buf, ever_modified, 1);
+	WriteSummaryValue(buf, removed_newgrfs ? 1 : 0, 1);
+
+	WriteSummaryValue(buf, Company::GetNumItems(), 1);
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		char name[MAX_LENGTH_COMPANY_NAME_CHARS * MAX_CHAR_LENGTH];
+		SetDParam(0, c->index);
+		GetString(name, STR_COMPANY_NAME, lastof(name));
+
+		WriteSummaryValue(buf, c->index, 1);
+		WriteSummaryValue(buf, c->inaugurated_year, 4);
+		WriteSummaryValue(buf, c->money, 8);
+		WriteSummaryString(buf, name);
+	}
+
+	uint grfs = 0;
+	for (const GRFConfig *gc = _grfconfig; gc != nullptr; gc = gc->next) grfs++;
+	WriteSummaryValue(buf, grfs, 2);
+	for (const GRFConfig *gc = _grfconfig; gc != nullptr; gc = gc->next) {
+		const uint8 *md5sum = HasBit(gc->flags, GCF_COMPATIBLE) ? gc->original_md5sum : gc->ident.md5sum;
+		WriteSummaryValue(buf, gc->ident.grfid, 4);
+		buf.insert(buf.end(), md5sum, md5sum + sizeof(gc->ident.md5sum));
+		WriteSummaryString(buf, gc->filename);
+	}
+}
+
+/** Reader for the fields of a savegame summary; reading past the end marks the summary as broken. */
+struct SavegameSummaryReader {
+	const byte *pos; ///< Current position in the summary.
+	const byte *end; ///< End of the summary.
+	bool ok;         ///< Whether everything could be read so far.
+
+	SavegameSummaryReader(const byte *buf, size_t len) : pos(buf), end(buf + len), ok(true) {}
+
+	/**
+	 * Read a big endian value.
+	 * @param bytes The number of bytes the value was written with.
+	 * @return The value, or 0 when the summary is too short.
+	 */
+	uint64 ReadValue(uint bytes)
+	{
+		if ((size_t)(this->end - this->pos) < bytes) {
+			this->ok = false;
+			return 0;
+		}
+		uint64 value = 0;
+		for (uint i = 0; i < bytes; i++) value = (value << 8) | *this->pos++;
+		return value;
+	}
+
+	/**
+	 * Read raw bytes.
+	 * @param dest Where to copy the bytes to.
+	 * @param len  The number of bytes to read.
+	 */
+	void ReadBytes(byte *dest, size_t len)
+	{
+		if ((size_t)(this->end - this->pos) < len) {
+			this->ok = false;
+			return;
+		}
+		memcpy(dest, this->pos, len);
+		this->pos += len;
+	}
+
+	/**
+	 * Read a string that is prefixed by its length.
+	 * @return The string, or an empty string when the summary is too short.
+	 */
+	std::string ReadString()
+	{
+		size_t len = this->ReadValue(2);
+		if ((size_t)(this->end - this->pos) < len) {
+			this->ok = false;
+			return std::string();
+		}
+		std::string str((const char *)this->pos, len);
+		this->pos += len;
+		return str;
+	}
+};
+
+/**
+ * Read the summary of a savegame without loading, or even decompressing, the savegame itself.
+ * @param f       The savegame file, positioned at its start.
+ * @param summary The summary to fill.
+ * @return True when the savegame has a valid summary, false for older or broken savegames.
+ */
+bool ReadSavegameSummary(FILE *f, SavegameSummary *summary)
+{
+	uint32 hdr[3];
+	if (fread(hdr, sizeof(hdr), 1, f) != 1) return false;
+
+	if (hdr[0] != DELTA_SAVEGAME_TAG) {
+		const SaveLoadFormat *fmt = _saveload_formats;
+		while (fmt != endof(_saveload_formats) && fmt->tag != hdr[0]) fmt++;
+		if (fmt == endof(_saveload_formats)) return false;
+	}
+
+	SaveLoadVersion version = (SaveLoadVersion)(TO_BE32(hdr[1]) >> 16);
+	if (version < SLV_SAVEGAME_SUMMARY || version > SAVEGAME_VERSION) return false;
+
+	uint32 len = TO_BE32(hdr[2]);
+	if (len > MAX_SAVEGAME_SUMMARY_SIZE) return false;
+
+	std::vector<byte> buf(len);
+	if (len != 0 && fread(buf.data(), len, 1, f) != 1) return false;
+
+	SavegameSummaryReader reader(buf.data(), len);
+	summary->version = version;
+	summary->date = (Date)reader.ReadValue(4);
+	summary->map_size_x = reader.ReadValue(4);
+	summary->map_size_y = reader.ReadValue(4);
+	summary->last_ottd_rev = reader.ReadValue(4);
+	summary->ever_modified = reader.ReadValue(1);
+	summary->removed_newgrfs = reader.ReadValue(1) != 0;
+
+	summary->companies.resize(reader.ReadValue(1));
+	for (SavegameSummaryCompany &company : summary->companies) {
+		company.index = (CompanyID)reader.ReadValue(1);
+		company.inaugurated_year = (Year)reader.ReadValue(4);
+		company.money = (Money)(int64)reader.ReadValue(8);
+		company.name = reader.ReadString();
+	}
+
+	summary->grfs.resize(reader.ReadValue(2));
+	for (SavegameSummaryGRF &grf : summary->grfs) {
+		grf.grfid = reader.ReadValue(4);
+		reader.ReadBytes(grf.md5sum, sizeof(grf.md5sum));
+		grf.filename = reader.ReadString();
+	}
+
+	return reader.ok;
+}
+
+/**
+ * Skip the summary in front of the savegame data; everything in it is in the chunks as well.
+ * @param lf The filter to read the savegame from.
+ */
+static void SlSkipSavegameSummary(LoadFilter *lf)
+{
+	byte len[4];
+	SlReadFilterExact(lf, len, sizeof(len));
+
+	uint32 size = (len[0] << 24) | (len[1] << 16) | (len[2] << 8) | len[3];
+	if (size > MAX_SAVEGAME_SUMMARY_SIZE) SlErrorCorrupt("Savegame summary too large");
+	SlReadFilterExact(lf, nullptr, size);
+}
+
+/**
+ * Open the savegame a delta savegame refers to, for reading its uncompressed data.
+ * @param name Name of the savegame, without directory.
+ * @return The filter to read the uncompressed savegame data from.
+ */
+static LoadFilter *SlOpenDeltaBase(const char *name)
+{
+	FILE *fh = FioFOpenFile(name, "rb", AUTOSAVE_DIR);
+	if (fh == nullptr) fh = FioFOpenFile(name, "rb", SAVE_DIR);
+	if (fh == nullptr) SlErrorCorruptFmt("Base savegame '%s' of delta savegame not found", name);
+
+	LoadFilter *lf = new FileReader(fh);
+	try {
+		uint32 hdr[2];
+		SlReadFilterExact(lf, (byte*)hdr, sizeof(hdr));
+
+		const SaveLoadFormat *fmt = _saveload_formats;
+		while (fmt != endof(_saveload_formats) && fmt->tag != hdr[0]) fmt++;
+		/* Delta savegames always refer to a complete savegame with a summary. */
+		if (fmt == endof(_saveload_formats) || fmt->init_load == nullptr) SlErrorCorrupt("Base of delta savegame is not a complete savegame");
+		SaveLoadVersion version = (SaveLoadVersion)(TO_BE32(hdr[1]) >> 16);
+		if (version < SLV_SAVEGAME_SUMMARY || version > SAVEGAME_VERSION) SlErrorCorrupt("Base of delta savegame has a different version");
+
+		SlSkipSavegameSummary(lf);
+		return fmt->init_load(lf);
+	} catch (...) {
+		delete lf;
+		throw;
+	}
+}
+
+/**
+ * Decompress the savegame a delta savegame refers to, and check it is the savegame the differences were made with.
+ * @param name   Name of the savegame, without directory.
+ * @param size   Size of the uncompressed data the differences were made with.
+ * @param md5sum MD5 digest of the uncompressed data the differences were made with.
+ * @return The uncompressed data of the savegame.
+ */
+static std::shared_ptr<const std::vector<byte>> SlReadDeltaBase(const char *name, uint64 size, const uint8 md5sum[16])
+{
+	std::shared_ptr<std::vector<byte>> data = std::make_shared<std::vector<byte>>();
+	data->reserve((size_t)min<uint64>(size, 1 << 30));
+
+	LoadFilter *lf = SlOpenDeltaBase(name);
+	try {
+		size_t read;
+		do {
+			size_t pos = data->size();
+			data->resize(pos + MEMORY_CHUNK_SIZE);
+			read = lf->Read(data->data() + pos, MEMORY_CHUNK_SIZE);
+			data->resize(pos + read);
+		} while (read != 0 && data->size() <= size);
+	} catch (...) {
+		delete lf;
+		throw;
+	}
+	delete lf;
+
+	/* Autosaves get overwritten, so make sure the base savegame is still the one the differences were made with. */
+	uint8 base_md5sum[16];
+	Md5 checksum;
+	checksum.Append(data->data(), data->size());
+	checksum.Finish(base_md5sum);
+	if (data->size() != size || memcmp(base_md5sum, md5sum, sizeof(base_md5sum)) != 0) {
+		SlErrorCorruptFmt("Base savegame '%s' of delta savegame has been overwritten", name);
+	}
+
+	return data;
+}
+
+/**
+ * Read the header of a delta savegame, that follows its summary.
+ * @param[out] base The uncompressed data of the base savegame, checked to be the savegame the differences were made with.
+ * @return The format the differences are compressed with.
+ */
+static const SaveLoadFormat *SlReadDeltaHeader(std::shared_ptr<const std::vector<byte>> *base)
+{
+	uint32 tag;
+	SlReadFilterExact(_sl.lf, (byte*)&tag, sizeof(tag));
+
+	const SaveLoadFormat *fmt = _saveload_formats;
+	while (fmt != endof(_saveload_formats) && fmt->tag != tag) fmt++;
+	if (fmt == endof(_saveload_formats)) SlErrorCorrupt("Unknown format of delta savegame");
+	if (fmt->init_load == nullptr) {
+		char err_str[64];
+		seprintf(err_str, lastof(err_str), "Loader for '%s' is not available.", fmt->name);
+		SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, err_str);
+	}
+
+	byte info[8 + 16 + 2];
+	SlReadFilterExact(_sl.lf, info, sizeof(info));
+	SavegameSummaryReader reader(info, sizeof(info));
+	uint64 size = reader.ReadValue(8);
+	uint8 md5sum[16];
+	reader.ReadBytes(md5sum, sizeof(md5sum));
+	size_t name_len = reader.ReadValue(2);
+
+	char name[MAX_PATH];
+	if (name_len >= lengthof(name)) SlErrorCorrupt("Name of base savegame too long");
+	SlReadFilterExact(_sl.lf, (byte*)name, name_len);
+	name[name_len] = '\0';
+	if (strchr(name, PATHSEPCHAR) != nullptr || strchr(name, '/') != nullptr) SlErrorCorrupt("Invalid name of base savegame");
+
+	DeltaLoadBase &cache = _delta_load_base;
+	if (cache.data != nullptr && cache.filename == name && cache.data->size() == size && memcmp(cache.md5sum, md5sum, sizeof(md5sum)) == 0) {
+		DEBUG(sl, 1, "Loading delta savegame relative to '%s', which is still in memory", name);
+	} else {
+		DEBUG(sl, 1, "Loading delta savegame relative to '%s'", name);
+		cache.data = nullptr;
+		cache.data = SlReadDeltaBase(name, size, md5sum);
+		cache.filename = name;
+		memcpy(cache.md5sum, md5sum, sizeof(cache.md5sum));
+	}
+
+	*base = cache.data;
+	return fmt;
+}
+
 /* actual loader/saver function */
 void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settings);
 extern bool AfterLoadGame();
@@ -2384,8 +3939,12 @@ extern bool LoadOldSaveGame(const char *file);
  */
 static inline void ClearSaveLoadState()
 {
-	delete _sl.dumper;
-	_sl.dumper = nullptr;
+	for (SaveSegment &segment : _sl.segments) delete segment.dumper;
+	_sl.segments.clear();
+	_sl.summary.clear();
+	_sl.delta_mode = SDM_NONE;
+	_sl_chunk.dumper = nullptr;
+	FreeMapSaveSource();
 
 	delete _sl.sf;
 	_sl.sf = nullptr;
@@ -2412,12 +3971,15 @@ static void SaveFileStart()
 	_sl.saveinprogress = true;
 }
 
-/** Update the gui accordingly when saving is done and release locks on saveload. */
+/** Update the gui accordingly when saving is done, log the chunks saved on the save thread and release locks on saveload. */
 static void SaveFileDone()
 {
 	if (_game_mode != GM_MENU) _fast_forward = _sl.ff_state;
 	SetMouseCursorBusy(false);
 
+	for (const SavedChunkInfo &info : _sl.saved_chunks) SlDebugSavedChunk(info.ch, info.size, info.save_time);
+	_sl.saved_chunks.clear();
+
 	InvalidateWindowData(WC_STATUS_BAR, 0, SBI_SAVELOAD_FINISH);
 	_sl.saveinprogress = false;
 }
@@ -2454,15 +4016,35 @@ static void SaveFileError()
 static SaveOrLoadResult SaveFileToDisk(bool threaded)
 {
 	try {
+		/* Finish writing our stuff to memory. */
+		SlSaveSnapshotChunks();
+
 		byte compression;
 		const SaveLoadFormat *fmt = GetSavegameFormat(_savegame_format, &compression);
 
 		/* We have written our stuff to memory, now write it to file! */
-		uint32 hdr[2] = { fmt->tag, TO_BE32(SAVEGAME_VERSION << 16) };
+		bool delta = _sl.delta_mode == SDM_DELTA;
+		uint32 hdr[3] = { delta ? DELTA_SAVEGAME_TAG : fmt->tag, TO_BE32(SAVEGAME_VERSION << 16), TO_BE32((uint32)_sl.summary.size()) };
 		_sl.sf->Write((byte*)hdr, sizeof(hdr));
+		/* The summary is not compressed, so it can be read without loading the savegame. */
+		if (!_sl.summary.empty()) _sl.sf->Write(_sl.summary.data(), _sl.summary.size());
+
+		if (delta) {
+			/* The format of the differences, and the savegame they are relative to. */
+			uint32 tag = fmt->tag;
+			_sl.sf->Write((byte*)&tag, sizeof(tag));
+
+			std::vector<byte> info;
+			WriteSummaryValue(info, _delta_base->size, 8);
+			info.insert(info.end(), _delta_base->md5sum, endof(_delta_base->md5sum));
+			WriteSummaryString(info, _delta_base->filename.c_str());
+			_sl.sf->Write(info.data(), info.size());
+		}
 
 		_sl.sf = fmt->init_write(_sl.sf, compression);
-		_sl.dumper->Flush(_sl.sf);
+		if (_sl.delta_mode != SDM_NONE) _sl.sf = new DeltaSaveFilter(_sl.sf, !delta, _sl.delta_name);
+		for (SaveSegment &segment : _sl.segments) segment.dumper->Flush(_sl.sf);
+		_sl.sf->Finish();
 
 		ClearSaveLoadState();
 
@@ -2507,18 +4089,36 @@ void WaitTillSaved()
  * using the writer, either in threaded mode if possible, or single-threaded.
  * @param writer   The filter to write the savegame to.
  * @param threaded Whether to try to perform the saving asynchronously.
+ * @param delta    Whether to save a checkpoint or only the differences with the last one, for delta autosaves.
+ * @param filename Name of the savegame; only needed for delta autosaves.
  * @return Return the result of the action. #SL_OK or #SL_ERROR
  */
-static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded)
+static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded, SaveDeltaMode delta = SDM_NONE, const char *filename = nullptr)
 {
 	assert(!_sl.saveinprogress);
 
-	_sl.dumper = new MemoryDumper();
 	_sl.sf = writer;
 
+	if (delta != SDM_NONE) {
+		const char *name = strrchr(filename, PATHSEPCHAR);
+		_sl.delta_name = (name == nullptr) ? filename : name + 1;
+
+		/* Differences can only be written relative to a complete savegame that is not about to be overwritten. */
+		if (delta == SDM_DELTA && (_delta_base == nullptr || _delta_base->filename == _sl.delta_name)) delta = SDM_CHECKPOINT;
+		if (delta == SDM_CHECKPOINT) {
+			delete _delta_base;
+			_delta_base = nullptr;
+		}
+		DEBUG(sl, 2, "Saving %s", delta == SDM_DELTA ? "differences with the last checkpoint" : "checkpoint for delta savegames");
+	}
+	_sl.delta_mode = delta;
+
 	_sl_version = SAVEGAME_VERSION;
 
 	SaveViewportBeforeSaveGame();
+	BuildSavegameSummary(_sl.summary);
+	/* When saving on another thread, the map chunks are saved from a copy of the map, so the game can continue meanwhile. */
+	SetMapSaveSource(threaded);
 	SlSaveChunks();
 
 	SaveFileStart();
@@ -2543,6 +4143,9 @@ static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded)
  */
 SaveOrLoadResult SaveWithFilter(SaveFilter *writer, bool threaded)
 {
+	/* The save thread might still be busy with saving the previous game. */
+	WaitTillSaved();
+
 	try {
 		_sl.action = SLA_SAVE;
 		return DoSave(writer, threaded);
@@ -2574,43 +4177,62 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 
 	/* see if we have any loader for this type. */
 	const SaveLoadFormat *fmt = _saveload_formats;
-	for (;;) {
-		/* No loader found, treat as version 0 and use LZO format */
-		if (fmt == endof(_saveload_formats)) {
-			DEBUG(sl, 0, "Unknown savegame type, trying to load it as the buggy format");
-			_sl.lf->Reset();
-			_sl_version = SL_MIN_VERSION;
-			_sl_minor_version = 0;
+	std::shared_ptr<const std::vector<byte>> delta_base;
+	if (hdr[0] == DELTA_SAVEGAME_TAG) {
+		_sl_version = (SaveLoadVersion)(TO_BE32(hdr[1]) >> 16);
+		_sl_minor_version = 0;
+
+		DEBUG(sl, 1, "Loading savegame version %d", _sl_version);
 
-			/* Try to find the LZO savegame format; it uses 'OTTD' as tag. */
-			fmt = _saveload_formats;
-			for (;;) {
-				if (fmt == endof(_saveload_formats)) {
-					/* Who removed LZO support? Bad bad boy! */
-					NOT_REACHED();
+		if (_sl_version > SAVEGAME_VERSION) SlError(STR_GAME_SAVELOAD_ERROR_TOO_NEW_SAVEGAME);
+		if (IsSavegameVersionBefore(SLV_SAVEGAME_SUMMARY)) SlErrorCorrupt("Delta savegame without summary");
+
+		SlSkipSavegameSummary(_sl.lf);
+		fmt = SlReadDeltaHeader(&delta_base);
+	} else {
+		/* The base of the previous delta savegame is only kept for loading another delta savegame right after it. */
+		_delta_load_base.data = nullptr;
+
+		for (;;) {
+			/* No loader found, treat as version 0 and use LZO format */
+			if (fmt == endof(_saveload_formats)) {
+				DEBUG(sl, 0, "Unknown savegame type, trying to load it as the buggy format");
+				_sl.lf->Reset();
+				_sl_version = SL_MIN_VERSION;
+				_sl_minor_version = 0;
+
+				/* Try to find the LZO savegame format; it uses 'OTTD' as tag. */
+				fmt = _saveload_formats;
+				for (;;) {
+					if (fmt == endof(_saveload_formats)) {
+						/* Who removed LZO support? Bad bad boy! */
+						NOT_REACHED();
+					}
+					if (fmt->tag == TO_BE32X('OTTD')) break;
+					fmt++;
 				}
-				if (fmt->tag == TO_BE32X('OTTD')) break;
-				fmt++;
+				break;
 			}
-			break;
-		}
 
-		if (fmt->tag == hdr[0]) {
-			/* check version number */
-			_sl_version = (SaveLoadVersion)(TO_BE32(hdr[1]) >> 16);
-			/* Minor is not used anymore from version 18.0, but it is still needed
-			 * in versions before that (4 cases) which can't be removed easy.
-			 * Therefore it is loaded, but never saved (or, it saves a 0 in any scenario). */
-			_sl_minor_version = (TO_BE32(hdr[1]) >> 8) & 0xFF;
+			if (fmt->tag == hdr[0]) {
+				/* check version number */
+				_sl_version = (SaveLoadVersion)(TO_BE32(hdr[1]) >> 16);
+				/* Minor is not used anymore from version 18.0, but it is still needed
+				 * in versions before that (4 cases) which can't be removed easy.
+				 * Therefore it is loaded, but never saved (or, it saves a 0 in any scenario). */
+				_sl_minor_version = (TO_BE32(hdr[1]) >> 8) & 0xFF;
 
-			DEBUG(sl, 1, "Loading savegame version %d", _sl_version);
+				DEBUG(sl, 1, "Loading savegame version %d", _sl_version);
 
-			/* Is the version higher than the current? */
-			if (_sl_version > SAVEGAME_VERSION) SlError(STR_GAME_SAVELOAD_ERROR_TOO_NEW_SAVEGAME);
-			break;
-		}
+				/* Is the version higher than the current? */
+				if (_sl_version > SAVEGAME_VERSION) SlError(STR_GAME_SAVELOAD_ERROR_TOO_NEW_SAVEGAME);
+
+				if (!IsSavegameVersionBefore(SLV_SAVEGAME_SUMMARY)) SlSkipSavegameSummary(_sl.lf);
+				break;
+			}
 
-		fmt++;
+			fmt++;
+		}
 	}
 
 	/* loader for this savegame type is not implemented? */
@@ -2621,6 +4243,10 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 	}
 
 	_sl.lf = fmt->init_load(_sl.lf);
+	if (delta_base != nullptr) _sl.lf = new DeltaLoadFilter(_sl.lf, delta_base);
+	/* Decompress on another thread while the chunks are being loaded. Uncompressed
+	 * savegames are instead read straight from the file, mapped into memory. */
+	if (fmt->tag != TO_BE32X('OTTN') || delta_base != nullptr) _sl.lf = new ReadAheadLoadFilter(_sl.lf);
 	_sl.reader = new ReadBuffer(_sl.lf);
 	_next_offs = 0;
 
@@ -2664,8 +4290,13 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		SlLoadCheckChunks();
 	} else {
 		/* Load chunks and resolve references */
+		auto start = std::chrono::steady_clock::now();
 		SlLoadChunks();
+		auto loaded = std::chrono::steady_clock::now();
 		SlFixPointers();
+		DEBUG(sl, 1, "Loaded chunks in %d ms, resolved references in %d ms",
+				(int)std::chrono::duration_cast<std::chrono::milliseconds>(loaded - start).count(),
+				(int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - loaded).count());
 	}
 
 	ClearSaveLoadState();
@@ -2698,6 +4329,9 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
  */
 SaveOrLoadResult LoadWithFilter(LoadFilter *reader)
 {
+	/* The save thread might still be busy with saving the previous game. */
+	WaitTillSaved();
+
 	try {
 		_sl.action = SLA_LOAD;
 		return DoLoad(reader, false);
@@ -2714,9 +4348,10 @@ SaveOrLoadResult LoadWithFilter(LoadFilter *reader)
  * @param fop Save or load mode. Load can also be a TTD(Patch) game.
  * @param sb The sub directory to save the savegame in
  * @param threaded True when threaded saving is allowed
+ * @param delta Whether to save a checkpoint or only the differences with the last one, for delta autosaves
  * @return Return the result of the action. #SL_OK, #SL_ERROR, or #SL_REINIT ("unload" the game)
  */
-SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, DetailedFileType dft, Subdirectory sb, bool threaded)
+SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, DetailedFileType dft, Subdirectory sb, bool threaded, SaveDeltaMode delta)
 {
 	/* An instance of saving is already active, so don't go saving again */
 	if (_sl.saveinprogress && fop == SLO_SAVE && dft == DFT_GAME_FILE && threaded) {
@@ -2781,7 +4416,7 @@ SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, Detaile
 			DEBUG(desync, 1, "save: %08x; %02x; %s", _date, _date_fract, filename);
 			if (_network_server || !_settings_client.gui.threaded_saves) threaded = false;
 
-			return DoSave(new FileWriter(fh), threaded);
+			return DoSave(new FileWriter(fh), threaded, delta, filename);
 		}
 
 		/* LOAD game */
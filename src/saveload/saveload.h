@@ -302,6 +302,7 @@ enum SaveLoadVersion : uint16 {
 
 	SLV_SCRIPT_MEMLIMIT,                    ///< 215  PR#7516 Limit on AI/GS memory consumption.
 	SLV_MULTITILE_DOCKS,                    ///< 216  PR#7380 Multiple docks per station.
+	SLV_SAVEGAME_SUMMARY,                   ///< 217  Uncompressed summary in front of the savegame data.
 
 	SL_MAX_VERSION,                         ///< Highest possible saveload version
 };
@@ -337,18 +338,26 @@ enum SavegameType {
 	SGT_INVALID = 0xFF, ///< broken savegame (used internally)
 };
 
+/** How a savegame is written with regard to delta autosaves. */
+enum SaveDeltaMode {
+	SDM_NONE,       ///< A normal savegame.
+	SDM_CHECKPOINT, ///< A normal savegame, that the following delta savegames refer to.
+	SDM_DELTA,      ///< Only the differences with the last checkpoint, when possible; otherwise a new checkpoint.
+};
+
 extern FileToSaveLoad _file_to_saveload;
 
 void GenerateDefaultSaveName(char *buf, const char *last);
 void SetSaveLoadError(StringID str);
 const char *GetSaveLoadErrorString();
-SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, DetailedFileType dft, Subdirectory sb, bool threaded = true);
+SaveOrLoadResult SaveOrLoad(const char *filename, SaveLoadOperation fop, DetailedFileType dft, Subdirectory sb, bool threaded = true, SaveDeltaMode delta = SDM_NONE);
 void WaitTillSaved();
 void ProcessAsyncSaveFinish();
 void DoExitSave();
 
 SaveOrLoadResult SaveWithFilter(struct SaveFilter *writer, bool threaded);
 SaveOrLoadResult LoadWithFilter(struct LoadFilter *reader);
+bool ReadSavegameSummary(FILE *f, struct SavegameSummary *summary);
 
 typedef void ChunkSaveLoadProc();
 typedef void AutolengthProc(void *arg);
@@ -391,6 +400,7 @@ enum ChunkType {
 	CH_TYPE_MASK    =  3,
 	CH_LAST         =  8, ///< Last chunk in this array.
 	CH_AUTO_LENGTH  = 16,
+	CH_SNAPSHOT     = 32, ///< The save proc only reads data copied when saving started, so it may run on the save thread.
 };
 
 /**
@@ -484,6 +494,7 @@ enum SaveLoadTypes {
 	SL_STR         =  3, ///< Save/load a string.
 	SL_LST         =  4, ///< Save/load a list.
 	SL_DEQUE       =  5, ///< Save/load a deque.
+	SL_REFDEQUE    =  6, ///< Save/load a deque of references.
 	/* non-normal save-load types */
 	SL_WRITEBYTE   =  8,
 	SL_VEH_INCLUDE =  9,
@@ -586,6 +597,17 @@ typedef SaveLoad SaveLoadGlobVarList;
  */
 #define SLE_CONDDEQUE(base, variable, type, from, to) SLE_GENERAL(SL_DEQUE, base, variable, type, 0, from, to)
 
+/**
+ * Storage of a deque of references in some savegame versions.
+ * The data is stored exactly like a list, so the two can be exchanged without a savegame bump.
+ * @param base     Name of the class or struct containing the deque.
+ * @param variable Name of the variable in the class or struct referenced by \a base.
+ * @param type     Type of the references, a value from #SLRefType.
+ * @param from     First savegame version that has the deque.
+ * @param to       Last savegame version that has the deque.
+ */
+#define SLE_CONDREFDEQUE(base, variable, type, from, to) SLE_GENERAL(SL_REFDEQUE, base, variable, type, 0, from, to)
+
 /**
  * Storage of a variable in every version of a savegame.
  * @param base     Name of the class or struct containing the variable.
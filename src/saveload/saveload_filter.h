@@ -39,6 +39,16 @@ struct LoadFilter {
 	 */
 	virtual size_t Read(byte *buf, size_t len) = 0;
 
+	/**
+	 * Read the next bytes of the savegame without copying them, when this filter is able to.
+	 * @param[out] len The number of bytes that have been read.
+	 * @return The bytes, valid as long as this filter exists, or \c nullptr when #Read has to be used instead.
+	 */
+	virtual const byte *ReadDirect(size_t *len)
+	{
+		return nullptr;
+	}
+
 	/**
 	 * Reset this filter to read from the beginning of the file.
 	 */
@@ -39,6 +39,8 @@ void UpdateHousesAndTowns();
 void UpdateOldAircraft();
 
 void SaveViewportBeforeSaveGame();
+void SetMapSaveSource(bool snapshot);
+void FreeMapSaveSource();
 void ResetViewportAfterLoadGame();
 
 void ConvertOldMultiheadToNew();
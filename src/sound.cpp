@@ -16,6 +16,7 @@
 #include "fios.h"
 #include "window_gui.h"
 #include "vehicle_base.h"
+#include "network/network.h"
 
 /* The type of set we're replacing */
 #define SET_TYPE "sounds"
@@ -238,7 +239,8 @@ void SndCopyToPool()
  */
 static void SndPlayScreenCoordFx(SoundID sound, int left, int right, int top, int bottom)
 {
-	if (_settings_client.music.effect_vol == 0) return;
+	/* Nobody wants to hear the sounds of the frames a client runs to catch up. */
+	if (_settings_client.music.effect_vol == 0 || _network_catching_up) return;
 
 	const Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
@@ -29,6 +29,7 @@
 #include "core/random_func.hpp"
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/linkgraphschedule.h"
+#include "tile_cmd.h"
 
 #include "table/strings.h"
 
@@ -417,6 +418,9 @@ void Station::RecomputeCatchment()
 	this->industries_near.clear();
 	this->RemoveFromAllNearbyLists();
 
+	/* The tile loops below visit the tiles in ascending order, which keeps this list sorted. */
+	this->acceptance_tiles.clear();
+
 	if (this->rect.IsEmpty()) {
 		this->catchment_tiles.Reset();
 		return;
@@ -428,6 +432,7 @@ void Station::RecomputeCatchment()
 		TILE_AREA_LOOP(tile, this->industry->location) {
 			if (IsTileType(tile, MP_INDUSTRY) && GetIndustryIndex(tile) == this->industry->index) {
 				this->catchment_tiles.SetTile(tile);
+				this->acceptance_tiles.push_back(tile);
 			}
 		}
 		/* The industry's stations_near may have been computed before its neutral station was built so clear and re-add here. */
@@ -458,6 +463,8 @@ void Station::RecomputeCatchment()
 	/* Search catchment tiles for towns and industries */
 	BitmapTileIterator it(this->catchment_tiles);
 	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+		if (MayTileAcceptCargo(tile)) this->acceptance_tiles.push_back(tile);
+
 		if (IsTileType(tile, MP_HOUSE)) {
 			Town *t = Town::GetByTile(tile);
 			t->stations_near.insert(this);
@@ -486,6 +493,19 @@ void Station::RecomputeCatchment()
 	FOR_ALL_STATIONS(st) { st->RecomputeCatchment(); }
 }
 
+/**
+ * Register a tile in the catchment area that may have started accepting cargo,
+ * e.g. because a house, industry or object was built on it.
+ * @param tile The tile to add; it must be in the catchment area.
+ */
+void Station::AddAcceptanceTile(TileIndex tile)
+{
+	assert(this->TileIsInCatchment(tile));
+	std::vector<TileIndex>::iterator it = std::lower_bound(this->acceptance_tiles.begin(), this->acceptance_tiles.end(), tile);
+	if (it != this->acceptance_tiles.end() && *it == tile) return;
+	this->acceptance_tiles.insert(it, tile);
+}
+
 /************************************************************************/
 /*                     StationRect implementation                       */
 /************************************************************************/
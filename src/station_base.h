@@ -22,6 +22,7 @@
 #include "bitmap_type.h"
 #include <map>
 #include <set>
+#include <vector>
 
 typedef Pool<BaseStation, StationID, 32, 64000> StationPool;
 extern StationPool _station_pool;
@@ -470,6 +471,7 @@ public:
 	IndustryType indtype;   ///< Industry type to get the name from
 
 	BitmapTileArea catchment_tiles; ///< NOSAVE: Set of individual tiles covered by catchment area
+	std::vector<TileIndex> acceptance_tiles; ///< NOSAVE: Sorted tiles in the catchment area that may accept cargo, @see UpdateStationAcceptance()
 
 	StationHadVehicleOfType had_vehicle_of_type;
 
@@ -506,6 +508,7 @@ public:
 	Rect GetCatchmentRect() const;
 	bool CatchmentCoversTown(TownID t) const;
 	void RemoveFromAllNearbyLists();
+	void AddAcceptanceTile(TileIndex tile);
 
 	inline bool TileIsInCatchment(TileIndex tile) const
 	{
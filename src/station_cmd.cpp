@@ -553,15 +553,20 @@ CargoArray GetAcceptanceAroundTiles(TileIndex tile, int w, int h, int rad, Cargo
  * @param st Station to get acceptance of.
  * @param always_accepted bitmask of cargo accepted by houses and headquarters; can be nullptr
  */
-static CargoArray GetAcceptanceAroundStation(const Station *st, CargoTypes *always_accepted)
+static CargoArray GetAcceptanceAroundStation(Station *st, CargoTypes *always_accepted)
 {
 	CargoArray acceptance;
 	if (always_accepted != nullptr) *always_accepted = 0;
 
-	BitmapTileIterator it(st->catchment_tiles);
-	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+	/* Only the tiles that may accept cargo are visited; tiles that lost their
+	 * ability to accept (e.g. a demolished house) are dropped from the list. */
+	std::vector<TileIndex>::iterator keep = st->acceptance_tiles.begin();
+	for (TileIndex tile : st->acceptance_tiles) {
+		if (!MayTileAcceptCargo(tile)) continue;
 		AddAcceptedCargo(tile, acceptance, always_accepted);
+		*keep++ = tile;
 	}
+	st->acceptance_tiles.erase(keep, st->acceptance_tiles.end());
 
 	return acceptance;
 }
@@ -4022,6 +4027,31 @@ void FindStationsAroundTiles(const TileArea &location, StationList * const stati
 	}
 }
 
+/**
+ * Register newly built tiles that may accept cargo (houses, industries, objects)
+ * with all stations whose catchment area covers them.
+ * @param location The area of the new tiles.
+ */
+void AddAcceptanceTilesToStations(const TileArea &location)
+{
+	std::set<StationID> seen_stations;
+
+	uint max_c = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
+	TileArea ta = TileArea(location).Expand(max_c);
+	TILE_AREA_LOOP(tile, ta) {
+		if (IsTileType(tile, MP_STATION)) seen_stations.insert(GetStationIndex(tile));
+	}
+
+	for (StationID stationid : seen_stations) {
+		Station *st = Station::GetIfValid(stationid);
+		if (st == nullptr) continue; /* Waypoint */
+
+		TILE_AREA_LOOP(tile, location) {
+			if (st->TileIsInCatchment(tile) && MayTileAcceptCargo(tile)) st->AddAcceptanceTile(tile);
+		}
+	}
+}
+
 /**
  * Run a tile loop to find stations around a tile, on demand. Cache the result for further requests
  * @return pointer to a StationList containing all stations found
@@ -4035,10 +4065,22 @@ const StationList *StationFinder::GetStations()
 	return &this->stations;
 }
 
-uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations)
+/**
+ * Distribute produced cargo over the (at most two) best rated stations around the source.
+ * @param type Cargo type produced.
+ * @param amount Amount of cargo produced.
+ * @param source_type Type of the source of the cargo.
+ * @param source_id Index of the source of the cargo.
+ * @param all_stations Candidate stations.
+ * @param source_tile If valid, only candidates whose catchment covers this tile are used.
+ *                    This allows passing the nearby stations of a town instead of
+ *                    building a filtered list for every house tile.
+ * @return Amount of cargo moved to the stations.
+ */
+uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, SourceID source_id, const StationList *all_stations, TileIndex source_tile)
 {
 	/* Return if nothing to do. Also the rounding below fails for 0. */
-	if (amount == 0) return 0;
+	if (amount == 0 || all_stations->empty()) return 0;
 
 	Station *st1 = nullptr;   // Station with best rating
 	Station *st2 = nullptr;   // Second best station
@@ -4046,6 +4088,9 @@ uint MoveGoodsToStation(CargoID type, uint amount, SourceType source_type, Sourc
 	uint best_rating2 = 0; // rating of st2
 
 	for (Station *st : *all_stations) {
+		/* Does the station cover the source at all? */
+		if (source_tile != INVALID_TILE && !st->TileIsInCatchment(source_tile)) continue;
+
 		/* Is the station reserved exclusively for somebody else? */
 		if (st->owner != OWNER_NONE && st->town->exclusive_counter > 0 && st->town->exclusivity != st->owner) continue;
 
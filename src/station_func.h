@@ -25,6 +25,7 @@
 void ModifyStationRatingAround(TileIndex tile, Owner owner, int amount, uint radius);
 
 void FindStationsAroundTiles(const TileArea &location, StationList *stations, bool use_nearby = true);
+void AddAcceptanceTilesToStations(const TileArea &location);
 
 void ShowStationViewWindow(StationID station);
 void UpdateAllStationVirtCoords();
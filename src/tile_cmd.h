@@ -168,6 +168,16 @@ VehicleEnterTileStatus VehicleEnterTile(Vehicle *v, TileIndex tile, int x, int y
 void ChangeTileOwner(TileIndex tile, Owner old_owner, Owner new_owner);
 void GetTileDesc(TileIndex tile, TileDesc *td);
 
+/**
+ * Test whether the type of a tile can accept cargo at all.
+ * @param tile Tile to test.
+ * @return True iff AddAcceptedCargo may add acceptance for this tile.
+ */
+static inline bool MayTileAcceptCargo(TileIndex tile)
+{
+	return _tile_type_procs[GetTileType(tile)]->add_accepted_cargo_proc != nullptr;
+}
+
 static inline void AddAcceptedCargo(TileIndex tile, CargoArray &acceptance, CargoTypes *always_accepted)
 {
 	AddAcceptedCargoProc *proc = _tile_type_procs[GetTileType(tile)]->add_accepted_cargo_proc;
@@ -528,7 +528,8 @@ static void TileLoop_Town(TileIndex tile)
 	Town *t = Town::GetByTile(tile);
 	uint32 r = Random();
 
-	StationFinder stations(TileArea(tile, 1, 1));
+	/* Nearby stations of the town, filtered by catchment of this tile in MoveGoodsToStation. */
+	const StationList *stations = &t->stations_near;
 
 	if (HasBit(hs->callback_mask, CBM_HOUSE_PRODUCE_CARGO)) {
 		for (uint i = 0; i < 256; i++) {
@@ -542,7 +543,7 @@ static void TileLoop_Town(TileIndex tile)
 			uint amt = GB(callback, 0, 8);
 			if (amt == 0) continue;
 
-			uint moved = MoveGoodsToStation(cargo, amt, ST_TOWN, t->index, stations.GetStations());
+			uint moved = MoveGoodsToStation(cargo, amt, ST_TOWN, t->index, stations, tile);
 
 			const CargoSpec *cs = CargoSpec::Get(cargo);
 			t->supplied[cs->Index()].new_max += amt;
@@ -557,7 +558,7 @@ static void TileLoop_Town(TileIndex tile)
 
 					if (EconomyIsInRecession()) amt = (amt + 1) >> 1;
 					t->supplied[CT_PASSENGERS].new_max += amt;
-					t->supplied[CT_PASSENGERS].new_act += MoveGoodsToStation(CT_PASSENGERS, amt, ST_TOWN, t->index, stations.GetStations());
+					t->supplied[CT_PASSENGERS].new_act += MoveGoodsToStation(CT_PASSENGERS, amt, ST_TOWN, t->index, stations, tile);
 				}
 
 				if (GB(r, 8, 8) < hs->mail_generation) {
@@ -565,7 +566,7 @@ static void TileLoop_Town(TileIndex tile)
 
 					if (EconomyIsInRecession()) amt = (amt + 1) >> 1;
 					t->supplied[CT_MAIL].new_max += amt;
-					t->supplied[CT_MAIL].new_act += MoveGoodsToStation(CT_MAIL, amt, ST_TOWN, t->index, stations.GetStations());
+					t->supplied[CT_MAIL].new_act += MoveGoodsToStation(CT_MAIL, amt, ST_TOWN, t->index, stations, tile);
 				}
 				break;
 
@@ -582,7 +583,7 @@ static void TileLoop_Town(TileIndex tile)
 					/* Adjust and apply */
 					if (EconomyIsInRecession()) amt = (amt + 1) >> 1;
 					t->supplied[CT_PASSENGERS].new_max += amt;
-					t->supplied[CT_PASSENGERS].new_act += MoveGoodsToStation(CT_PASSENGERS, amt, ST_TOWN, t->index, stations.GetStations());
+					t->supplied[CT_PASSENGERS].new_act += MoveGoodsToStation(CT_PASSENGERS, amt, ST_TOWN, t->index, stations, tile);
 
 					/* Do the same for mail, with a fresh random */
 					r = Random();
@@ -591,7 +592,7 @@ static void TileLoop_Town(TileIndex tile)
 					amt = CountBits(r & genmask);
 					if (EconomyIsInRecession()) amt = (amt + 1) >> 1;
 					t->supplied[CT_MAIL].new_max += amt;
-					t->supplied[CT_MAIL].new_act += MoveGoodsToStation(CT_MAIL, amt, ST_TOWN, t->index, stations.GetStations());
+					t->supplied[CT_MAIL].new_act += MoveGoodsToStation(CT_MAIL, amt, ST_TOWN, t->index, stations, tile);
 				}
 				break;
 
@@ -2244,7 +2245,13 @@ static void MakeTownHouse(TileIndex t, Town *town, byte counter, byte stage, Hou
 	if (size & BUILDING_2_TILES_X)   ClearMakeHouseTile(t + TileDiffXY(1, 0), town, counter, stage, ++type, random_bits);
 	if (size & BUILDING_HAS_4_TILES) ClearMakeHouseTile(t + TileDiffXY(1, 1), town, counter, stage, ++type, random_bits);
 
-	if (!_generating_world) FindStationsAroundTiles(TileArea(t, (size & BUILDING_2_TILES_X) ? 2 : 1, (size & BUILDING_2_TILES_Y) ? 2 : 1), &town->stations_near, false);
+	TileArea ta(t, (size & BUILDING_2_TILES_X) ? 2 : 1, (size & BUILDING_2_TILES_Y) ? 2 : 1);
+	/* Nothing to register while no station exists, e.g. when generating the world.
+	 * Do not test _generating_world; founding a town sets it as well. */
+	if (BaseStation::GetNumItems() == 0) return;
+
+	AddAcceptanceTilesToStations(ta);
+	FindStationsAroundTiles(ta, &town->stations_near, false);
 }
 
 
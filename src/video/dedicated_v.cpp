@@ -259,12 +259,15 @@ void VideoDriver_Dedicated::MainLoop()
 #endif
 
 	/* Load the dedicated server stuff */
-	_is_network_server = true;
+	_is_network_server = !_is_network_relay;
 	_network_dedicated = true;
 	_current_company = _local_company = COMPANY_SPECTATOR;
 
-	/* If SwitchMode is SM_LOAD_GAME, it means that the user used the '-g' options */
-	if (_switch_mode != SM_LOAD_GAME) {
+	/* A relay gets its game from the server it is already connecting to.
+	 * If SwitchMode is SM_LOAD_GAME, it means that the user used the '-g' options */
+	if (_is_network_relay) {
+		DEBUG(net, 0, "Relaying the game of the server to spectators");
+	} else if (_switch_mode != SM_LOAD_GAME) {
 		StartNewGameWithoutGUI(GENERATE_NEW_SEED);
 		SwitchToMode(_switch_mode);
 		_switch_mode = SM_NONE;
@@ -284,7 +287,7 @@ void VideoDriver_Dedicated::MainLoop()
 
 	/* Done loading, start game! */
 
-	if (!_networking) {
+	if (!_networking && !_is_network_relay) {
 		DEBUG(net, 0, "Dedicated server could not be started, aborting");
 		return;
 	}
@@ -307,11 +310,15 @@ void VideoDriver_Dedicated::MainLoop()
 		/* Don't sleep when fast forwarding (for desync debugging) */
 		if (!_ddc_fastforward) {
 			/* Sleep longer on a dedicated server, if the game is paused and no clients connected.
-			 * That can allow the CPU to better use deep sleep states. */
+			 * That can allow the CPU to better use deep sleep states. Otherwise handle network
+			 * traffic as it arrives until the next tick is due. */
+			uint32 now = GetTime();
 			if (_pause_mode != 0 && !HasClients()) {
-				CSleep(100);
+				NetworkServerWaitForEvents(100);
+			} else if (next_tick > now && next_tick - now <= MILLISECONDS_PER_TICK) {
+				NetworkServerWaitForEvents(next_tick - now);
 			} else {
-				CSleep(1);
+				NetworkServerWaitForEvents(1);
 			}
 		}
 	}
@@ -12,6 +12,7 @@
 #include "../stdafx.h"
 #include "../gfx_func.h"
 #include "../blitter/factory.hpp"
+#include "../openttd.h"
 #include "null_v.h"
 
 #include "../safeguards.h"
@@ -46,7 +47,7 @@ void VideoDriver_Null::MainLoop()
 {
 	uint i;
 
-	for (i = 0; i < this->ticks; i++) {
+	for (i = 0; i < this->ticks && !_exit_game; i++) {
 		GameLoop();
 		UpdateWindows();
 	}
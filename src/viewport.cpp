@@ -1868,6 +1868,9 @@ static void MarkViewportDirty(const ViewPort *vp, int left, int top, int right,
  */
 void MarkAllViewportsDirty(int left, int top, int right, int bottom)
 {
+	/* Nothing gets drawn while catching up; everything is redrawn afterwards. */
+	if (_network_catching_up) return;
+
 	Window *w;
 	FOR_ALL_WINDOWS_FROM_BACK(w) {
 		ViewPort *vp = w->viewport;
@@ -3331,6 +3331,9 @@ void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
  */
 void CallWindowGameTickEvent()
 {
+	/* The windows only need to be updated for the frames that are actually shown. */
+	if (_network_catching_up) return;
+
 	Window *w;
 	FOR_ALL_WINDOWS_FROM_FRONT(w) {
 		w->OnGameTick();